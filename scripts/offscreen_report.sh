@@ -0,0 +1,21 @@
+#!/bin/sh
+# Time the texture upload and present path of each upload mode without a
+# display, e.g. on CI machines without a GPU: GLFW's null platform with an EGL
+# surfaceless context on Mesa's llvmpipe (see --offscreen). Prints the JSON
+# lines of every run; the checksums should agree between modes.
+#
+# Usage: scripts/offscreen_report.sh [FRAMES] [WxH]
+set -e
+cd "$(dirname "$0")/.."
+
+frames=${1:-300}
+size=${2:-800x600}
+
+dir=build/release
+cmake -S . -B "$dir" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$dir" -j > /dev/null
+
+for upload in direct pbo persistent persistent-flush; do
+    LIBGL_ALWAYS_SOFTWARE=${LIBGL_ALWAYS_SOFTWARE:-1} \
+        "$dir/lvgl_glfw_example" --size="$size" --upload=$upload --offscreen="$frames" | grep '^{'
+done
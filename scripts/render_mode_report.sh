@@ -0,0 +1,31 @@
+#!/bin/sh
+# Compare direct rendering (one full-screen draw buffer) with partial rendering
+# (band buffers) at several window sizes: draw buffer memory and full-screen
+# frame time, uploads included (see --bench and --render).
+#
+# Usage: scripts/render_mode_report.sh [FRAMES] [WxH...]
+#        scripts/render_mode_report.sh 100 800x600 1920x1080 3840x2160
+set -e
+cd "$(dirname "$0")/.."
+
+frames=${1:-100}
+[ $# -gt 0 ] && shift
+sizes=${*:-"800x600 1920x1080 3840x2160"}
+bands=${BANDS:-10}
+
+dir=build/release
+cmake -S . -B "$dir" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$dir" -j > /dev/null
+
+printf "%10s %8s %12s %10s %10s %10s\n" size render "buffers KiB" "avg ms" "min ms" "max ms"
+for size in $sizes; do
+    for render in direct partial; do
+        line=$("$dir/lvgl_glfw_example" --size="$size" --render=$render --bands="$bands" --bench="$frames" |
+               grep '^\[bench\]')
+        kib=$(echo "$line" | sed -n 's/.*(\([0-9.]*\) KiB draw buffers).*/\1/p')
+        avg=$(echo "$line" | sed -n 's/.*avg \([0-9.]*\) ms.*/\1/p')
+        min=$(echo "$line" | sed -n 's/.*min \([0-9.]*\) ms.*/\1/p')
+        max=$(echo "$line" | sed -n 's/.*max \([0-9.]*\) ms.*/\1/p')
+        printf "%10s %8s %12s %10s %10s %10s\n" "$size" "$render" "$kib" "$avg" "$min" "$max"
+    done
+done
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Build the app once per SW draw thread count and report the full-screen frame
+# time of each build (see --bench). One thread is the default LV_OS_NONE build.
+# The caching draw units are turned off: they claim the bands tiled_draw splits
+# off and copy them on one thread, which would hide how rasterization scales.
+#
+# Usage: scripts/scaling_report.sh [FRAMES] [THREAD_COUNT...]
+#        scripts/scaling_report.sh 200 1 2 4 8 16
+set -e
+cd "$(dirname "$0")/.."
+
+frames=${1:-100}
+[ $# -gt 0 ] && shift
+threads=${*:-"1 2 4 8"}
+
+printf "%8s %12s %12s %12s %9s\n" threads "avg ms" "min ms" "max ms" speedup
+base=
+for n in $threads; do
+    if [ "$n" -gt 1 ]; then parallel=ON; else parallel=OFF; fi
+    dir=build/scaling-$n
+    cmake -S . -B "$dir" -DCMAKE_BUILD_TYPE=Release \
+          -DLVGL_GLFW_PARALLEL=$parallel -DLVGL_GLFW_DRAW_THREADS="$n" > /dev/null
+    cmake --build "$dir" -j > /dev/null
+
+    line=$("$dir/lvgl_glfw_example" --bench="$frames" \
+               --grad-cache=off --mask-cache=off --layer-cache=off | grep '^\[bench\]')
+    avg=$(echo "$line" | sed -n 's/.*avg \([0-9.]*\) ms.*/\1/p')
+    min=$(echo "$line" | sed -n 's/.*min \([0-9.]*\) ms.*/\1/p')
+    max=$(echo "$line" | sed -n 's/.*max \([0-9.]*\) ms.*/\1/p')
+    [ -z "$base" ] && base=$avg
+    printf "%8s %12s %12s %12s %8.2fx\n" "$n" "$avg" "$min" "$max" "$(awk "BEGIN { print $base / $avg }")"
+done
@@ -0,0 +1,403 @@
+// Headless benchmark: the example's widgets and draw units rendered into memory
+// on a deterministic tick, with no window, GL context or input. Each scene is
+// built on a clean screen, warmed up, then driven for a fixed number of frames;
+// one JSON object per line goes to stdout for every scene.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "lvgl.h"
+#include "buffer_pool.h"
+#include "demo_scene.h"
+#include "grad_draw.h"
+#include "layer_cache.h"
+#include "mask_draw.h"
+#include "percentile.h"
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
+#include "blend_x86.h"
+#endif
+
+#define BENCH_WIDTH 800
+#define BENCH_HEIGHT 600
+#define BENCH_FRAMES 300
+#define WARMUP_FRAMES 10    // fill the caches before timing
+#define FRAME_MS 16         // simulated time between frames
+#define BANDS 10            // --render=partial
+
+#define WIDGET_CELLS 30     // scenes stay well inside the 64 KiB LVGL heap (LV_MEM_SIZE)
+#define LIST_ITEMS 16
+#define SCROLL_STEP 6       // [px] per frame
+#define MOVING_BOXES 6
+
+typedef struct {
+    const char * name;
+    void (*create)(lv_obj_t * screen);
+    void (*step)(uint32_t frame);   // before each frame, may be NULL
+} scene_t;
+
+static struct {
+    int32_t width;
+    int32_t height;
+    int frames;
+    bool partial;
+    const char * scene;     // NULL: all of them
+} options = {
+    .width = BENCH_WIDTH,
+    .height = BENCH_HEIGHT,
+    .frames = BENCH_FRAMES,
+};
+
+static lv_display_t * disp;
+static uint32_t tick_ms;
+static uint64_t flushed_px;
+static uint8_t * frame;     // partial mode: where the bands are flushed to
+static size_t frame_capacity;
+
+static lv_obj_t * bars[WIDGET_CELLS];
+static int bar_count;
+static lv_obj_t * list;
+static int scroll_dir;
+
+static uint32_t tick_get_cb(void)
+{
+    return tick_ms;
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void flush_cb(lv_display_t * display, const lv_area_t * area, uint8_t * px_map)
+{
+    flushed_px += lv_area_get_size(area);
+
+    if (options.partial) {
+        // The band is rendered into again next, so its rows go to the frame, as an upload would take them
+        int32_t frame_stride = options.width * sizeof(lv_color32_t);
+        int32_t row_bytes = lv_area_get_width(area) * sizeof(lv_color32_t);
+        int32_t stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), lv_display_get_color_format(display));
+        for (int32_t y = area->y1; y <= area->y2; y++)
+            memcpy(frame + y * frame_stride + area->x1 * sizeof(lv_color32_t), px_map + (y - area->y1) * stride,
+                   row_bytes);
+    }
+    lv_display_flush_ready(display);
+}
+
+// LVGL heap bytes in use now, and the most ever in use. The high-water mark also
+// catches the draw tasks, layers and label buffers freed again before
+// lv_refr_now returns; it cannot be reset.
+static void heap_usage(size_t * used, size_t * max_used)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    *used = mon.total_size - mon.free_size;
+    *max_used = mon.max_used;
+}
+
+static long rss_peak_kib(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;  // KiB on Linux
+}
+
+// The example window: gradient, labels and the three buttons, fully redrawn every
+// frame as after a resize or expose
+static void demo_create(lv_obj_t * screen)
+{
+    demo_scene_create_background(screen);
+
+    lv_obj_t * label = lv_label_create(screen);
+    lv_label_set_text_fmt(label, "Resolution: %dx%d", (int)options.width, (int)options.height);
+    lv_obj_align(label, LV_ALIGN_TOP_LEFT, 10, 10);
+    label = lv_label_create(screen);
+    lv_label_set_text(label, "Frames: 0");
+    lv_obj_align(label, LV_ALIGN_TOP_LEFT, 10, 40);
+    label = lv_label_create(screen);
+    lv_label_set_text(label, "Hello, World! This text is selectable.");
+    lv_obj_align(label, LV_ALIGN_CENTER, 0, -40);
+
+    demo_scene_create_buttons(screen);
+}
+
+static void demo_step(uint32_t frame_index)
+{
+    lv_obj_invalidate(lv_screen_active());
+}
+
+// A wrapped grid of buttons, sliders, switches, checkboxes and bars, the
+// sliders and bars all moving every frame: many small areas per refresh
+static void widgets_create(lv_obj_t * screen)
+{
+    lv_obj_set_flex_flow(screen, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_style_pad_all(screen, 8, 0);
+    lv_obj_set_style_pad_gap(screen, 8, 0);
+
+    bar_count = 0;
+    for (int i = 0; i < WIDGET_CELLS; i++) {
+        lv_obj_t * obj;
+        switch (i % 5) {
+        case 0:
+            obj = lv_button_create(screen);
+            lv_label_set_text_fmt(lv_label_create(obj), "Button %d", i);
+            break;
+        case 1:
+            obj = lv_slider_create(screen);
+            lv_obj_set_width(obj, 120);
+            bars[bar_count++] = obj;
+            break;
+        case 2:
+            obj = lv_switch_create(screen);
+            if (i % 3 == 0)
+                lv_obj_add_state(obj, LV_STATE_CHECKED);
+            break;
+        case 3:
+            obj = lv_checkbox_create(screen);
+            lv_checkbox_set_text(obj, "Check");
+            break;
+        default:
+            obj = lv_bar_create(screen);
+            lv_obj_set_width(obj, 120);
+            bars[bar_count++] = obj;
+            break;
+        }
+    }
+}
+
+static void widgets_step(uint32_t frame_index)
+{
+    for (int i = 0; i < bar_count; i++)
+        lv_bar_set_value(bars[i], (int32_t)((frame_index * 3 + i * 17) % 101), LV_ANIM_OFF);
+}
+
+// A list scrolled a few pixels every frame, turning around at either end
+static void scroll_create(lv_obj_t * screen)
+{
+    list = lv_list_create(screen);
+    lv_obj_set_size(list, lv_pct(60), lv_pct(90));
+    lv_obj_center(list);
+    for (int i = 0; i < LIST_ITEMS; i++) {
+        char text[32];
+        snprintf(text, sizeof(text), "List item %d", i);
+        lv_list_add_button(list, LV_SYMBOL_FILE, text);
+    }
+    scroll_dir = 1;
+}
+
+static void scroll_step(uint32_t frame_index)
+{
+    if (scroll_dir > 0 && lv_obj_get_scroll_bottom(list) <= 0)
+        scroll_dir = -1;
+    else if (scroll_dir < 0 && lv_obj_get_scroll_top(list) <= 0)
+        scroll_dir = 1;
+    lv_obj_scroll_by(list, 0, -scroll_dir * SCROLL_STEP, LV_ANIM_OFF);
+}
+
+static void box_x_anim_cb(void * var, int32_t value)
+{
+    lv_obj_set_x(var, value);
+}
+
+// LVGL animations on the simulated clock: the layer-cached fading panel and
+// boxes with shadows sliding over the gradient
+static void animation_create(lv_obj_t * screen)
+{
+    demo_scene_create_background(screen);
+    demo_scene_create_fading_panel(screen);
+
+    for (int i = 0; i < MOVING_BOXES; i++) {
+        lv_obj_t * box = lv_obj_create(screen);
+        lv_obj_set_size(box, 60, 40);
+        lv_obj_set_y(box, 20 + i * 60);
+        lv_obj_set_style_radius(box, 8, 0);
+        lv_obj_set_style_shadow_width(box, 12, 0);
+        lv_obj_set_style_bg_color(box, lv_palette_main((lv_palette_t)(i % LV_PALETTE_LAST)), 0);
+
+        lv_anim_t a;
+        lv_anim_init(&a);
+        lv_anim_set_var(&a, box);
+        lv_anim_set_values(&a, 0, options.width - 60);
+        lv_anim_set_duration(&a, 900 + i * 250);
+        lv_anim_set_playback_duration(&a, 900 + i * 250);
+        lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+        lv_anim_set_exec_cb(&a, box_x_anim_cb);
+        lv_anim_start(&a);
+    }
+}
+
+static const scene_t scenes[] = {
+    { "demo", demo_create, demo_step },
+    { "widgets", widgets_create, widgets_step },
+    { "scroll", scroll_create, scroll_step },
+    { "animation", animation_create, NULL },
+};
+
+// One frame: advance the clock, let the scene and the animations change things,
+// render. lv_timer_handler never runs, so nothing happens between frames.
+static void run_frame(const scene_t * scene, uint32_t frame_index)
+{
+    tick_ms += FRAME_MS;
+    if (scene->step)
+        scene->step(frame_index);
+    lv_anim_refr_now();
+    lv_refr_now(disp);
+}
+
+static void run_scene(const scene_t * scene)
+{
+    lv_obj_t * screen = lv_screen_active();
+    lv_obj_clean(screen);
+    lv_obj_remove_style_all(screen);
+    lv_obj_set_style_bg_opa(screen, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(screen, lv_color_white(), 0);
+
+    // The peak is reported above what the clean screen holds. A scene that stays
+    // below an earlier scene's high-water mark reports that mark, an upper bound;
+    // --scene=NAME measures one scene alone.
+    size_t heap_baseline, heap_max;
+    heap_usage(&heap_baseline, &heap_max);
+    scene->create(screen);
+    lv_obj_invalidate(screen);
+    for (uint32_t i = 0; i < WARMUP_FRAMES; i++)
+        run_frame(scene, i);
+
+    double * times = malloc(options.frames * sizeof(double));
+    if (!times) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    flushed_px = 0;
+    double total = 0.0;
+    for (int i = 0; i < options.frames; i++) {
+        double start = now_ms();
+        run_frame(scene, WARMUP_FRAMES + i);
+        times[i] = now_ms() - start;
+        total += times[i];
+    }
+    size_t heap_used;
+    heap_usage(&heap_used, &heap_max);
+
+    percentile_sort(times, options.frames);
+    printf("{\"scene\": \"%s\", \"frames\": %d, \"avg_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, "
+           "\"p99_ms\": %.4f, \"max_ms\": %.4f, \"pixels\": %llu, \"mpx_per_s\": %.2f, "
+           "\"lv_heap_peak_bytes\": %zu, \"rss_peak_kib\": %ld}\n",
+           scene->name, options.frames, total / options.frames, percentile(times, options.frames, 0.50),
+           percentile(times, options.frames, 0.95), percentile(times, options.frames, 0.99),
+           times[options.frames - 1], (unsigned long long)flushed_px,
+           total > 0.0 ? flushed_px / (total * 1000.0) : 0.0, heap_max - heap_baseline, rss_peak_kib());
+    fflush(stdout);
+    free(times);
+}
+
+static void usage(const char * argv0)
+{
+    fprintf(stderr, "Usage: %s [--frames=N] [--size=WxH] [--render=direct|partial] [--scene=NAME]\n"
+                    "Scenes:", argv0);
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+        fprintf(stderr, " %s", scenes[i].name);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void parse_options(int argc, char ** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--frames=", 9) == 0) {
+            options.frames = atoi(argv[i] + 9);
+            if (options.frames <= 0)
+                usage(argv[0]);
+        }
+        else if (strncmp(argv[i], "--size=", 7) == 0) {
+            int width, height;
+            if (sscanf(argv[i] + 7, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+                usage(argv[0]);
+            options.width = width;
+            options.height = height;
+        }
+        else if (strcmp(argv[i], "--render=direct") == 0) {
+            options.partial = false;
+        }
+        else if (strcmp(argv[i], "--render=partial") == 0) {
+            options.partial = true;
+        }
+        else if (strncmp(argv[i], "--scene=", 8) == 0) {
+            options.scene = argv[i] + 8;
+        }
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            usage(argv[0]);
+        }
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    parse_options(argc, argv);
+
+    lv_init();
+    lv_tick_set_cb(tick_get_cb);
+
+    const char * blend_name = "c";
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
+    blend_x86_init();
+    blend_name = blend_x86_level_name(blend_x86_get_level());
+#endif
+
+    // The same draw units as the example, minus the GL one
+    grad_draw_init();
+    grad_draw_set_enabled(true);
+    mask_draw_init();
+    mask_draw_set_enabled(true);
+    layer_cache_init();
+    layer_cache_set_enabled(true);
+
+    disp = lv_display_create(options.width, options.height);
+    lv_display_set_flush_cb(disp, flush_cb);
+    size_t frame_size = (size_t)options.width * options.height * sizeof(lv_color32_t);
+    void * buf;
+    size_t buf_capacity = 0;
+    if (options.partial) {
+        int32_t rows = (options.height + BANDS - 1) / BANDS;
+        size_t band_size = (size_t)options.width * rows * sizeof(lv_color32_t);
+        buf = buffer_pool_resize(NULL, &buf_capacity, band_size);
+        frame = buffer_pool_resize(NULL, &frame_capacity, frame_size);
+        lv_display_set_buffers(disp, buf, NULL, band_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    }
+    else {
+        buf = buffer_pool_resize(NULL, &buf_capacity, frame_size);
+        lv_display_set_buffers(disp, buf, NULL, frame_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    }
+    if (!buf || (options.partial && !frame)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("{\"bench\": \"lvgl_glfw_bench\", \"width\": %d, \"height\": %d, \"render\": \"%s\", \"frames\": %d, "
+           "\"frame_ms\": %d, \"draw_units\": %d, \"blend\": \"%s\"}\n",
+           (int)options.width, (int)options.height, options.partial ? "partial" : "direct", options.frames,
+           FRAME_MS, LV_DRAW_SW_DRAW_UNIT_CNT, blend_name);
+
+    bool found = false;
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        if (options.scene && strcmp(options.scene, scenes[i].name) != 0)
+            continue;
+        run_scene(&scenes[i]);
+        found = true;
+    }
+    if (!found) {
+        fprintf(stderr, "Unknown scene: %s\n", options.scene);
+        usage(argv[0]);
+    }
+
+    grad_draw_set_enabled(false);
+    mask_draw_set_enabled(false);
+    layer_cache_set_enabled(false);
+    buffer_pool_release(buf, buf_capacity);
+    buffer_pool_release(frame, frame_capacity);
+    buffer_pool_trim();
+    return 0;
+}
@@ -0,0 +1,223 @@
+#define GL_SILENCE_DEPRECATION
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GLFW/glfw3.h>
+#include "lvgl_private.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_rgb888.h"
+#include "src/draw/sw/blend/lv_draw_sw_blend_to_argb8888.h"
+#include "blend_x86.h"
+#include "blend_bench.h"
+
+#define BENCH_WIDTH 256
+#define BENCH_HEIGHT 128    // 128 KiB per buffer, so the kernels rather than memory are measured
+#define VERIFY_WIDTH 67     // not a multiple of the vector width, so the scalar tails run too
+#define VERIFY_HEIGHT 5
+
+typedef struct {
+    const char *name;
+    bool image;             // ARGB8888 image, else a color fill
+    bool mask;
+    lv_opa_t opa;
+    bool argb8888_layer;    // blend into an ARGB8888 layer instead of the XRGB8888 display
+} blend_case_t;
+
+static const blend_case_t cases[] = {
+    { "fill", false, false, LV_OPA_COVER, false },
+    { "fill opa", false, false, LV_OPA_50, false },
+    { "fill mask", false, true, LV_OPA_COVER, false },
+    { "fill mask opa", false, true, LV_OPA_50, false },
+    { "image", true, false, LV_OPA_COVER, false },
+    { "image opa", true, false, LV_OPA_50, false },
+    { "image mask", true, true, LV_OPA_COVER, false },
+    { "image mask opa", true, true, LV_OPA_50, false },
+    { "fill argb8888 layer", false, false, LV_OPA_COVER, true },
+};
+
+#define CASE_COUNT (int)(sizeof(cases) / sizeof(cases[0]))
+
+typedef struct {
+    int32_t width;
+    int32_t height;
+    uint8_t *dest;
+    uint8_t *initial;       // dest before the blend, to run C and SIMD on the same input
+    uint8_t *reference;     // dest as LVGL's C code left it
+    uint8_t *src;           // ARGB8888
+    uint8_t *mask;
+} blend_buffers_t;
+
+// Mostly covered or empty with some partial coverage in between, like anti-aliased
+// edges and images with soft borders
+static uint8_t random_coverage(void)
+{
+    int r = rand() % 8;
+    return r < 3 ? LV_OPA_COVER : r < 5 ? LV_OPA_TRANSP : (uint8_t)rand();
+}
+
+static bool alloc_buffers(blend_buffers_t *b, int32_t width, int32_t height)
+{
+    size_t bytes = (size_t)width * height * 4;
+    b->width = width;
+    b->height = height;
+    b->dest = malloc(bytes);
+    b->initial = malloc(bytes);
+    b->reference = malloc(bytes);
+    b->src = malloc(bytes);
+    b->mask = malloc((size_t)width * height);
+    if (!b->dest || !b->initial || !b->reference || !b->src || !b->mask)
+        return false;
+
+    srand(1);
+    for (size_t i = 0; i < bytes; i++) {
+        b->initial[i] = (uint8_t)rand();
+        b->src[i] = i % 4 == 3 ? random_coverage() : (uint8_t)rand();
+    }
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        b->mask[i] = random_coverage();
+    return true;
+}
+
+static void free_buffers(blend_buffers_t *b)
+{
+    free(b->dest);
+    free(b->initial);
+    free(b->reference);
+    free(b->src);
+    free(b->mask);
+}
+
+// Blend through LVGL's entry point, which calls the hooks or falls back to C
+static void run_case(const blend_case_t *c, blend_buffers_t *b)
+{
+    lv_area_t area = { 0, 0, b->width - 1, b->height - 1 };
+
+    if (c->image) {
+        lv_draw_sw_blend_image_dsc_t dsc;
+        memset(&dsc, 0, sizeof(dsc));
+        dsc.dest_buf = b->dest;
+        dsc.dest_w = b->width;
+        dsc.dest_h = b->height;
+        dsc.dest_stride = b->width * 4;
+        dsc.mask_buf = c->mask ? b->mask : NULL;
+        dsc.mask_stride = b->width;
+        dsc.src_buf = b->src;
+        dsc.src_stride = b->width * 4;
+        dsc.src_color_format = LV_COLOR_FORMAT_ARGB8888;
+        dsc.opa = c->opa;
+        dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+        dsc.relative_area = area;
+        dsc.src_area = area;
+        lv_draw_sw_blend_image_to_rgb888(&dsc, 4);
+        return;
+    }
+
+    lv_draw_sw_blend_fill_dsc_t dsc;
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.dest_buf = b->dest;
+    dsc.dest_w = b->width;
+    dsc.dest_h = b->height;
+    dsc.dest_stride = b->width * 4;
+    dsc.mask_buf = c->mask ? b->mask : NULL;
+    dsc.mask_stride = b->width;
+    dsc.color = lv_color_hex(0x3d7fc1);
+    dsc.opa = c->opa;
+    dsc.relative_area = area;
+    if (c->argb8888_layer)
+        lv_draw_sw_blend_color_to_argb8888(&dsc);
+    else
+        lv_draw_sw_blend_color_to_rgb888(&dsc, 4);
+}
+
+// Pixels where `level` and LVGL's C code disagree
+static size_t compare_case(const blend_case_t *c, blend_buffers_t *b, blend_x86_level_t level)
+{
+    size_t bytes = (size_t)b->width * b->height * 4;
+    blend_x86_level_t saved = blend_x86_get_level();
+
+    blend_x86_set_level(BLEND_X86_NONE);
+    memcpy(b->dest, b->initial, bytes);
+    run_case(c, b);
+    memcpy(b->reference, b->dest, bytes);
+
+    blend_x86_set_level(level);
+    memcpy(b->dest, b->initial, bytes);
+    run_case(c, b);
+    blend_x86_set_level(saved);
+
+    size_t differing = 0;
+    for (size_t i = 0; i < bytes; i += 4) {
+        if (memcmp(b->dest + i, b->reference + i, 4) != 0)
+            differing++;
+    }
+    return differing;
+}
+
+// Mpx/s of `iterations` blends at `level`
+static double time_case(const blend_case_t *c, blend_buffers_t *b, blend_x86_level_t level, int iterations)
+{
+    blend_x86_level_t saved = blend_x86_get_level();
+    blend_x86_set_level(level);
+    memcpy(b->dest, b->initial, (size_t)b->width * b->height * 4);
+
+    run_case(c, b);  // warm up
+    double start = glfwGetTime();
+    for (int i = 0; i < iterations; i++)
+        run_case(c, b);
+    double seconds = glfwGetTime() - start;
+
+    blend_x86_set_level(saved);
+    return seconds > 0.0 ? (double)b->width * b->height * iterations / seconds / 1e6 : 0.0;
+}
+
+bool blend_bench_verify(void)
+{
+    blend_x86_level_t level = blend_x86_get_level();
+    if (level == BLEND_X86_NONE)
+        return true;
+
+    blend_buffers_t b;
+    bool ok = alloc_buffers(&b, VERIFY_WIDTH, VERIFY_HEIGHT);
+    for (int i = 0; ok && i < CASE_COUNT; i++) {
+        size_t differing = compare_case(&cases[i], &b, level);
+        if (differing) {
+            fprintf(stderr, "[blend] %s: %s differs from LVGL's C path in %zu pixels, SIMD blending disabled\n",
+                    cases[i].name, blend_x86_level_name(level), differing);
+            ok = false;
+        }
+    }
+    free_buffers(&b);
+
+    if (!ok)
+        blend_x86_set_level(BLEND_X86_NONE);
+    return ok;
+}
+
+void blend_bench_run(int iterations)
+{
+    blend_x86_level_t cpu_level = blend_x86_get_cpu_level();
+    blend_buffers_t b;
+    if (!alloc_buffers(&b, BENCH_WIDTH, BENCH_HEIGHT)) {
+        free_buffers(&b);
+        return;
+    }
+
+    printf("[blend] %dx%d px, %d iterations, CPU supports %s\n", BENCH_WIDTH, BENCH_HEIGHT, iterations,
+           blend_x86_level_name(cpu_level));
+    for (int i = 0; i < CASE_COUNT; i++) {
+        const blend_case_t *c = &cases[i];
+        double c_mpx = time_case(c, &b, BLEND_X86_NONE, iterations);
+        printf("[blend] %-20s C %8.1f Mpx/s", c->name, c_mpx);
+
+        size_t differing = 0;
+        for (blend_x86_level_t l = BLEND_X86_SSE2; l <= cpu_level; l++) {
+            double mpx = time_case(c, &b, l, iterations);
+            printf(", %s %8.1f Mpx/s (%.2fx)", blend_x86_level_name(l), mpx, c_mpx > 0.0 ? mpx / c_mpx : 0.0);
+            differing += compare_case(c, &b, l);
+        }
+        if (differing)
+            printf(", %zu pixels differ\n", differing);
+        else
+            printf(", exact\n");
+    }
+    free_buffers(&b);
+}
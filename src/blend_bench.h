@@ -0,0 +1,18 @@
+#ifndef BLEND_BENCH_H
+#define BLEND_BENCH_H
+
+#include <stdbool.h>
+
+// Exercises the blend hooks of blend_x86.h through LVGL's own blend entry points,
+// once with the SIMD level in use and once with the hooks declined (LVGL's C
+// code), and compares the results pixel by pixel.
+
+// Quick check on a small, odd-sized buffer. On any difference the hooks are
+// switched off (BLEND_X86_NONE) and false is returned.
+bool blend_bench_verify(void);
+
+// Time every kernel at every level the CPU supports over `iterations` runs on a
+// cache-resident buffer and print Mpx/s, the speedup over C and exactness.
+void blend_bench_run(int iterations);
+
+#endif // BLEND_BENCH_H
@@ -0,0 +1,365 @@
+#include <string.h>
+#include "lvgl_private.h"
+#include "blend_x86.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BLEND_X86_SUPPORTED 1
+#include <immintrin.h>
+#else
+#define BLEND_X86_SUPPORTED 0
+#endif
+
+#define AVX2 __attribute__((target("avx2")))
+
+// How the per-pixel mix factor is formed, mirroring LVGL's four blend branches
+typedef enum {
+    MIX_OPA,        // opa
+    MIX_MASK,       // mask[x]
+    MIX_MASK_OPA,   // LV_OPA_MIX2(mask[x], opa)
+} color_mix_t;
+
+typedef enum {
+    MIX_ALPHA,              // src alpha
+    MIX_ALPHA_OPA,          // LV_OPA_MIX2(alpha, opa)
+    MIX_ALPHA_MASK,         // LV_OPA_MIX2(alpha, mask[x])
+    MIX_ALPHA_MASK_OPA,     // LV_OPA_MIX3(alpha, mask[x], opa)
+} image_mix_t;
+
+static blend_x86_level_t level;
+static blend_x86_level_t cpu_level;
+
+// LVGL's lv_color_24_24_mix on the first three bytes of a pixel; the fourth is never written
+static inline void mix_pixel(uint8_t *dest, const uint8_t *src, uint32_t mix)
+{
+    if (mix == 0)
+        return;
+    if (mix >= LV_OPA_MAX) {
+        dest[0] = src[0];
+        dest[1] = src[1];
+        dest[2] = src[2];
+        return;
+    }
+
+    uint32_t mix_inv = 255 - mix;
+    dest[0] = (src[0] * mix + dest[0] * mix_inv) >> 8;
+    dest[1] = (src[1] * mix + dest[1] * mix_inv) >> 8;
+    dest[2] = (src[2] * mix + dest[2] * mix_inv) >> 8;
+}
+
+static inline uint32_t color_mix_factor(color_mix_t mode, const uint8_t *mask, int32_t x, uint32_t opa)
+{
+    switch (mode) {
+        case MIX_OPA: return opa;
+        case MIX_MASK: return mask[x];
+        case MIX_MASK_OPA: return (mask[x] * opa) >> 8;
+    }
+    return 0;
+}
+
+static inline uint32_t image_mix_factor(image_mix_t mode, uint32_t alpha, const uint8_t *mask, int32_t x, uint32_t opa)
+{
+    switch (mode) {
+        case MIX_ALPHA: return alpha;
+        case MIX_ALPHA_OPA: return (alpha * opa) >> 8;
+        case MIX_ALPHA_MASK: return (alpha * mask[x]) >> 8;
+        case MIX_ALPHA_MASK_OPA: return (alpha * mask[x] * opa) >> 16;
+    }
+    return 0;
+}
+
+#if BLEND_X86_SUPPORTED
+
+static inline __m128i select_sse2(__m128i a, __m128i b, __m128i take_b)
+{
+    return _mm_or_si128(_mm_andnot_si128(take_b, a), _mm_and_si128(take_b, b));
+}
+
+// Four pixels of `s` over `d`; `m` holds each pixel's mix factor in a 32-bit lane
+static inline __m128i mix4_sse2(__m128i d, __m128i s, __m128i m)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v255 = _mm_set1_epi16(255);
+
+    // Spread the factor over the four 16-bit channels of its pixel
+    __m128i t = _mm_unpacklo_epi32(m, m);
+    __m128i m_lo = _mm_or_si128(t, _mm_slli_epi32(t, 16));
+    t = _mm_unpackhi_epi32(m, m);
+    __m128i m_hi = _mm_or_si128(t, _mm_slli_epi32(t, 16));
+
+    // src * mix + dest * (255 - mix) is at most 255 * 255, so it fits 16 unsigned bits
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), m_lo),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(v255, m_lo)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), m_hi),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(v255, m_hi)));
+    __m128i r = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+
+    r = select_sse2(r, s, _mm_cmpgt_epi32(m, _mm_set1_epi32(LV_OPA_MAX - 1)));
+    r = select_sse2(r, d, _mm_cmpeq_epi32(m, zero));
+    return select_sse2(r, d, _mm_set1_epi32((int)0xff000000));
+}
+
+static inline __m128i load_mask4_sse2(const uint8_t *mask)
+{
+    uint32_t bytes;
+    memcpy(&bytes, mask, 4);
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)bytes), zero), zero);
+}
+
+// Lanes hold values below 256, so the 16-bit multiply is exact and leaves the upper half zero
+static inline __m128i mul_shift8_sse2(__m128i a, __m128i b)
+{
+    return _mm_srli_epi32(_mm_mullo_epi16(a, b), 8);
+}
+
+static void fill_row_sse2(uint32_t *dest, uint32_t color, int32_t w)
+{
+    __m128i c = _mm_set1_epi32((int)color);
+    int32_t x = 0;
+    for (; x <= w - 4; x += 4)
+        _mm_storeu_si128((__m128i *)(dest + x), c);
+    for (; x < w; x++)
+        dest[x] = color;
+}
+
+static void color_mix_row_sse2(uint8_t *dest, uint32_t color, const uint8_t *mask, int32_t w,
+                               uint32_t opa, color_mix_t mode)
+{
+    __m128i s = _mm_set1_epi32((int)color);
+    __m128i o = _mm_set1_epi32((int)opa);
+    int32_t x = 0;
+    for (; x <= w - 4; x += 4) {
+        __m128i m = mode == MIX_OPA ? o : load_mask4_sse2(mask + x);
+        if (mode == MIX_MASK_OPA)
+            m = mul_shift8_sse2(m, o);
+        __m128i d = _mm_loadu_si128((const __m128i *)(dest + x * 4));
+        _mm_storeu_si128((__m128i *)(dest + x * 4), mix4_sse2(d, s, m));
+    }
+    for (; x < w; x++)
+        mix_pixel(dest + x * 4, (const uint8_t *)&color, color_mix_factor(mode, mask, x, opa));
+}
+
+static void image_mix_row_sse2(uint8_t *dest, const uint8_t *src, const uint8_t *mask, int32_t w,
+                               uint32_t opa, image_mix_t mode)
+{
+    __m128i o = _mm_set1_epi32((int)opa);
+    int32_t x = 0;
+    for (; x <= w - 4; x += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + x * 4));
+        __m128i m = _mm_srli_epi32(s, 24);
+        if (mode == MIX_ALPHA_OPA)
+            m = mul_shift8_sse2(m, o);
+        else if (mode == MIX_ALPHA_MASK)
+            m = mul_shift8_sse2(m, load_mask4_sse2(mask + x));
+        else if (mode == MIX_ALPHA_MASK_OPA)
+            m = _mm_mulhi_epu16(_mm_mullo_epi16(m, load_mask4_sse2(mask + x)), o);  // (a * m * opa) >> 16
+        __m128i d = _mm_loadu_si128((const __m128i *)(dest + x * 4));
+        _mm_storeu_si128((__m128i *)(dest + x * 4), mix4_sse2(d, s, m));
+    }
+    for (; x < w; x++)
+        mix_pixel(dest + x * 4, src + x * 4, image_mix_factor(mode, src[x * 4 + 3], mask, x, opa));
+}
+
+static inline AVX2 __m256i select_avx2(__m256i a, __m256i b, __m256i take_b)
+{
+    return _mm256_blendv_epi8(a, b, take_b);
+}
+
+// The AVX2 twin of mix4_sse2 for eight pixels; every step stays within 128-bit lanes
+static inline AVX2 __m256i mix8_avx2(__m256i d, __m256i s, __m256i m)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i v255 = _mm256_set1_epi16(255);
+
+    __m256i t = _mm256_unpacklo_epi32(m, m);
+    __m256i m_lo = _mm256_or_si256(t, _mm256_slli_epi32(t, 16));
+    t = _mm256_unpackhi_epi32(m, m);
+    __m256i m_hi = _mm256_or_si256(t, _mm256_slli_epi32(t, 16));
+
+    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), m_lo),
+                                  _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(v255, m_lo)));
+    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), m_hi),
+                                  _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(v255, m_hi)));
+    __m256i r = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+
+    r = select_avx2(r, s, _mm256_cmpgt_epi32(m, _mm256_set1_epi32(LV_OPA_MAX - 1)));
+    r = select_avx2(r, d, _mm256_cmpeq_epi32(m, zero));
+    return select_avx2(r, d, _mm256_set1_epi32((int)0xff000000));
+}
+
+static inline AVX2 __m256i load_mask8_avx2(const uint8_t *mask)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)mask));
+}
+
+static AVX2 void fill_row_avx2(uint32_t *dest, uint32_t color, int32_t w)
+{
+    __m256i c = _mm256_set1_epi32((int)color);
+    int32_t x = 0;
+    for (; x <= w - 8; x += 8)
+        _mm256_storeu_si256((__m256i *)(dest + x), c);
+    for (; x < w; x++)
+        dest[x] = color;
+}
+
+static AVX2 void color_mix_row_avx2(uint8_t *dest, uint32_t color, const uint8_t *mask, int32_t w,
+                                    uint32_t opa, color_mix_t mode)
+{
+    __m256i s = _mm256_set1_epi32((int)color);
+    __m256i o = _mm256_set1_epi32((int)opa);
+    int32_t x = 0;
+    for (; x <= w - 8; x += 8) {
+        __m256i m = mode == MIX_OPA ? o : load_mask8_avx2(mask + x);
+        if (mode == MIX_MASK_OPA)
+            m = _mm256_srli_epi32(_mm256_mullo_epi32(m, o), 8);
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dest + x * 4));
+        _mm256_storeu_si256((__m256i *)(dest + x * 4), mix8_avx2(d, s, m));
+    }
+    for (; x < w; x++)
+        mix_pixel(dest + x * 4, (const uint8_t *)&color, color_mix_factor(mode, mask, x, opa));
+}
+
+static AVX2 void image_mix_row_avx2(uint8_t *dest, const uint8_t *src, const uint8_t *mask, int32_t w,
+                                    uint32_t opa, image_mix_t mode)
+{
+    __m256i o = _mm256_set1_epi32((int)opa);
+    int32_t x = 0;
+    for (; x <= w - 8; x += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + x * 4));
+        __m256i m = _mm256_srli_epi32(s, 24);
+        if (mode == MIX_ALPHA_OPA)
+            m = _mm256_srli_epi32(_mm256_mullo_epi32(m, o), 8);
+        else if (mode == MIX_ALPHA_MASK)
+            m = _mm256_srli_epi32(_mm256_mullo_epi32(m, load_mask8_avx2(mask + x)), 8);
+        else if (mode == MIX_ALPHA_MASK_OPA)
+            m = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(m, load_mask8_avx2(mask + x)), o), 16);
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dest + x * 4));
+        _mm256_storeu_si256((__m256i *)(dest + x * 4), mix8_avx2(d, s, m));
+    }
+    for (; x < w; x++)
+        mix_pixel(dest + x * 4, src + x * 4, image_mix_factor(mode, src[x * 4 + 3], mask, x, opa));
+}
+
+#endif // BLEND_X86_SUPPORTED
+
+void blend_x86_init(void)
+{
+    cpu_level = BLEND_X86_NONE;
+#if BLEND_X86_SUPPORTED
+    __builtin_cpu_init();
+    cpu_level = __builtin_cpu_supports("avx2") ? BLEND_X86_AVX2 : BLEND_X86_SSE2;
+#endif
+    level = cpu_level;
+}
+
+blend_x86_level_t blend_x86_set_level(blend_x86_level_t requested)
+{
+    level = requested < cpu_level ? requested : cpu_level;
+    return level;
+}
+
+blend_x86_level_t blend_x86_get_level(void)
+{
+    return level;
+}
+
+blend_x86_level_t blend_x86_get_cpu_level(void)
+{
+    return cpu_level;
+}
+
+const char *blend_x86_level_name(blend_x86_level_t l)
+{
+    switch (l) {
+        case BLEND_X86_NONE: return "none";
+        case BLEND_X86_SSE2: return "sse2";
+        case BLEND_X86_AVX2: return "avx2";
+    }
+    return "?";
+}
+
+bool blend_x86_parse_level(const char *name, blend_x86_level_t *out)
+{
+    for (int l = BLEND_X86_NONE; l <= BLEND_X86_AVX2; l++) {
+        if (strcmp(name, blend_x86_level_name((blend_x86_level_t)l)) == 0) {
+            *out = (blend_x86_level_t)l;
+            return true;
+        }
+    }
+    return false;
+}
+
+lv_result_t blend_x86_color_fill(const lv_draw_sw_blend_fill_dsc_t *dsc, uint32_t dest_px_size)
+{
+#if BLEND_X86_SUPPORTED
+    if (level == BLEND_X86_NONE || dest_px_size != 4)
+        return LV_RESULT_INVALID;
+
+    uint32_t color = lv_color_to_u32(dsc->color);
+    uint8_t *dest = dsc->dest_buf;
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        if (level == BLEND_X86_AVX2)
+            fill_row_avx2((uint32_t *)dest, color, dsc->dest_w);
+        else
+            fill_row_sse2((uint32_t *)dest, color, dsc->dest_w);
+        dest += dsc->dest_stride;
+    }
+    return LV_RESULT_OK;
+#else
+    return LV_RESULT_INVALID;
+#endif
+}
+
+lv_result_t blend_x86_color_mix(const lv_draw_sw_blend_fill_dsc_t *dsc, uint32_t dest_px_size)
+{
+#if BLEND_X86_SUPPORTED
+    if (level == BLEND_X86_NONE || dest_px_size != 4)
+        return LV_RESULT_INVALID;
+
+    // Same branch conditions as lv_draw_sw_blend_color_to_rgb888
+    const uint8_t *mask = dsc->mask_buf;
+    color_mix_t mode = mask == NULL ? MIX_OPA : dsc->opa >= LV_OPA_MAX ? MIX_MASK : MIX_MASK_OPA;
+    uint32_t color = lv_color_to_u32(dsc->color);
+    uint8_t *dest = dsc->dest_buf;
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        if (level == BLEND_X86_AVX2)
+            color_mix_row_avx2(dest, color, mask, dsc->dest_w, dsc->opa, mode);
+        else
+            color_mix_row_sse2(dest, color, mask, dsc->dest_w, dsc->opa, mode);
+        dest += dsc->dest_stride;
+        if (mask)
+            mask += dsc->mask_stride;
+    }
+    return LV_RESULT_OK;
+#else
+    return LV_RESULT_INVALID;
+#endif
+}
+
+lv_result_t blend_x86_argb8888_mix(const lv_draw_sw_blend_image_dsc_t *dsc, uint32_t dest_px_size)
+{
+#if BLEND_X86_SUPPORTED
+    if (level == BLEND_X86_NONE || dest_px_size != 4 || dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+        return LV_RESULT_INVALID;
+
+    const uint8_t *mask = dsc->mask_buf;
+    bool full_opa = dsc->opa >= LV_OPA_MAX;
+    image_mix_t mode = mask == NULL ? (full_opa ? MIX_ALPHA : MIX_ALPHA_OPA)
+                                    : (full_opa ? MIX_ALPHA_MASK : MIX_ALPHA_MASK_OPA);
+    const uint8_t *src = dsc->src_buf;
+    uint8_t *dest = dsc->dest_buf;
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        if (level == BLEND_X86_AVX2)
+            image_mix_row_avx2(dest, src, mask, dsc->dest_w, dsc->opa, mode);
+        else
+            image_mix_row_sse2(dest, src, mask, dsc->dest_w, dsc->opa, mode);
+        dest += dsc->dest_stride;
+        src += dsc->src_stride;
+        if (mask)
+            mask += dsc->mask_stride;
+    }
+    return LV_RESULT_OK;
+#else
+    return LV_RESULT_INVALID;
+#endif
+}
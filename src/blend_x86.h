@@ -0,0 +1,64 @@
+#ifndef BLEND_X86_H
+#define BLEND_X86_H
+
+// SSE2/AVX2 kernels for LVGL's SW blend stage, hooked in through
+// LV_USE_DRAW_SW_ASM = LV_DRAW_SW_ASM_CUSTOM (see LVGL_GLFW_SIMD). LVGL includes
+// this header from its blend sources, where lv_result_t and the blend
+// descriptors are already declared.
+//
+// Covered, for XRGB8888 targets (LVGL's RGB888 blender with 4-byte pixels):
+// color fills with and without opa/mask, and ARGB8888 images in the normal
+// blend mode with and without opa/mask. For ARGB8888 targets only the opaque
+// fill; mixing into a layer with alpha stays in C. Every kernel reproduces
+// LVGL's integer arithmetic, so the output is identical to the C path, and
+// returns LV_RESULT_INVALID for anything it does not handle, which makes LVGL
+// run its C code instead.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct _lv_draw_sw_blend_fill_dsc_t;
+struct _lv_draw_sw_blend_image_dsc_t;
+
+typedef enum {
+    BLEND_X86_NONE,     // every hook declines: plain LVGL C
+    BLEND_X86_SSE2,     // x86-64 baseline
+    BLEND_X86_AVX2,
+} blend_x86_level_t;
+
+// Pick the best level the CPU supports. Call before LVGL renders anything.
+void blend_x86_init(void);
+
+// Force a level (clamped to what the CPU supports); only while nothing renders.
+blend_x86_level_t blend_x86_set_level(blend_x86_level_t level);
+blend_x86_level_t blend_x86_get_level(void);
+blend_x86_level_t blend_x86_get_cpu_level(void);
+const char *blend_x86_level_name(blend_x86_level_t level);
+bool blend_x86_parse_level(const char *name, blend_x86_level_t *level);
+
+lv_result_t blend_x86_color_fill(const struct _lv_draw_sw_blend_fill_dsc_t *dsc, uint32_t dest_px_size);
+lv_result_t blend_x86_color_mix(const struct _lv_draw_sw_blend_fill_dsc_t *dsc, uint32_t dest_px_size);
+lv_result_t blend_x86_argb8888_mix(const struct _lv_draw_sw_blend_image_dsc_t *dsc, uint32_t dest_px_size);
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB888(dsc, dest_px_size) \
+    blend_x86_color_fill(dsc, dest_px_size)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB888_WITH_OPA(dsc, dest_px_size) \
+    blend_x86_color_mix(dsc, dest_px_size)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB888_WITH_MASK(dsc, dest_px_size) \
+    blend_x86_color_mix(dsc, dest_px_size)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB888_MIX_MASK_OPA(dsc, dest_px_size) \
+    blend_x86_color_mix(dsc, dest_px_size)
+
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB888(dsc, dest_px_size) \
+    blend_x86_argb8888_mix(dsc, dest_px_size)
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB888_WITH_OPA(dsc, dest_px_size) \
+    blend_x86_argb8888_mix(dsc, dest_px_size)
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB888_WITH_MASK(dsc, dest_px_size) \
+    blend_x86_argb8888_mix(dsc, dest_px_size)
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB888_MIX_MASK_OPA(dsc, dest_px_size) \
+    blend_x86_argb8888_mix(dsc, dest_px_size)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888(dsc) \
+    blend_x86_color_fill(dsc, 4)
+
+#endif // BLEND_X86_H
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <string.h>
+#include "buffer_pool.h"
+
+typedef struct {
+    void *ptr;
+    size_t capacity;
+} pool_entry_t;
+
+static pool_entry_t released[BUFFER_POOL_MAX_FREE];  // oldest first
+static int released_count;
+static buffer_pool_stats_t stats;
+
+size_t buffer_pool_size_class(size_t size)
+{
+    if (size <= BUFFER_POOL_MIN_CLASS)
+        return BUFFER_POOL_MIN_CLASS;
+
+    size_t power = BUFFER_POOL_MIN_CLASS;
+    while (power <= size / 2)
+        power *= 2;
+
+    // power <= size < 2 * power; round up to the next quarter of power
+    size_t step = power / 4;
+    return (size + step - 1) / step * step;
+}
+
+bool buffer_pool_fits(size_t capacity, size_t size)
+{
+    return capacity >= size && capacity <= 2 * buffer_pool_size_class(size);
+}
+
+void *buffer_pool_resize(void *ptr, size_t *capacity, size_t size)
+{
+    if (ptr && buffer_pool_fits(*capacity, size))
+        return ptr;
+
+    stats.requests++;
+    if (ptr)
+        buffer_pool_release(ptr, *capacity);
+
+    // Smallest released buffer that fits
+    int best = -1;
+    for (int i = 0; i < released_count; i++) {
+        if (buffer_pool_fits(released[i].capacity, size) && (best < 0 || released[i].capacity < released[best].capacity))
+            best = i;
+    }
+    if (best >= 0) {
+        ptr = released[best].ptr;
+        *capacity = released[best].capacity;
+        stats.cached_bytes -= *capacity;
+        memmove(&released[best], &released[best + 1], (released_count - best - 1) * sizeof(released[0]));
+        released_count--;
+        stats.reuses++;
+        return ptr;
+    }
+
+    *capacity = buffer_pool_size_class(size);
+    ptr = malloc(*capacity);
+    if (!ptr)
+        *capacity = 0;
+    stats.allocations++;
+    return ptr;
+}
+
+void buffer_pool_release(void *ptr, size_t capacity)
+{
+    if (!ptr)
+        return;
+
+    if (released_count == BUFFER_POOL_MAX_FREE) {
+        free(released[0].ptr);
+        stats.cached_bytes -= released[0].capacity;
+        memmove(&released[0], &released[1], (BUFFER_POOL_MAX_FREE - 1) * sizeof(released[0]));
+        released_count--;
+    }
+    released[released_count].ptr = ptr;
+    released[released_count].capacity = capacity;
+    released_count++;
+    stats.cached_bytes += capacity;
+}
+
+void buffer_pool_trim(void)
+{
+    for (int i = 0; i < released_count; i++)
+        free(released[i].ptr);
+    released_count = 0;
+    stats.cached_bytes = 0;
+}
+
+void buffer_pool_get_stats(buffer_pool_stats_t *out, bool reset)
+{
+    *out = stats;
+    if (reset) {
+        stats.requests = 0;
+        stats.reuses = 0;
+        stats.allocations = 0;
+    }
+}
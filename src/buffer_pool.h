@@ -0,0 +1,42 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Frame-sized allocations in size classes: each power of two is split into
+// four steps, so a buffer has up to 25% headroom and a window that grows a
+// little keeps its buffer. Released buffers are kept for reuse, up to
+// BUFFER_POOL_MAX_FREE of them. Not thread-safe; in the threaded loop mode
+// only the LVGL thread allocates from it after start-up.
+
+#define BUFFER_POOL_MIN_CLASS 4096
+#define BUFFER_POOL_MAX_FREE 4
+
+typedef struct {
+    uint32_t requests;      // buffer_pool_resize calls that needed a different buffer
+    uint32_t reuses;        // served from a released buffer
+    uint32_t allocations;   // served by malloc
+    size_t cached_bytes;    // held by released buffers right now
+} buffer_pool_stats_t;
+
+// The capacity a buffer of `size` bytes is allocated with.
+size_t buffer_pool_size_class(size_t size);
+
+// Return a buffer of at least `size` bytes. `ptr` (NULL or a pool buffer with
+// `*capacity` bytes) is kept if it is large enough and not more than twice the
+// size class, else it is released and replaced. Contents are not preserved.
+void *buffer_pool_resize(void *ptr, size_t *capacity, size_t size);
+
+// Whether buffer_pool_resize would keep a buffer of `capacity` bytes for `size`.
+bool buffer_pool_fits(size_t capacity, size_t size);
+
+void buffer_pool_release(void *ptr, size_t capacity);
+
+// Free the released buffers.
+void buffer_pool_trim(void);
+
+void buffer_pool_get_stats(buffer_pool_stats_t *stats, bool reset);
+
+#endif // BUFFER_POOL_H
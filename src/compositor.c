@@ -0,0 +1,203 @@
+#define GL_SILENCE_DEPRECATION
+#include <math.h>
+#include <string.h>
+#include "compositor.h"
+#include "buffer_pool.h"
+#include "presenter.h"
+
+struct compositor_layer {
+    lv_display_t *disp;
+    GLuint texture;
+    int32_t texture_capacity_width;
+    int32_t texture_capacity_height;
+    uint8_t *buf;
+    size_t buf_capacity;
+    bool opaque;
+    bool transformed;
+    float transform[6];
+};
+
+static compositor_layer_t layers[COMPOSITOR_MAX_LAYERS];
+static int layer_count;
+static bool damaged;
+static compositor_stats_t stats;
+
+static int32_t texture_capacity(int32_t size)
+{
+    // Same headroom as the main texture: 1/8, in steps of 64 texels
+    GLint max_size;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    return LV_MIN((size + size / 8 + 63) & ~63, max_size);
+}
+
+static void update_presenter(void)
+{
+    presenter_layer_t out[COMPOSITOR_MAX_LAYERS];
+    for (int i = 0; i < layer_count; i++) {
+        const compositor_layer_t *layer = &layers[i];
+        out[i].texture = layer->texture;
+        out[i].crop_u = (float)lv_display_get_horizontal_resolution(layer->disp) / layer->texture_capacity_width;
+        out[i].crop_v = (float)lv_display_get_vertical_resolution(layer->disp) / layer->texture_capacity_height;
+        out[i].blend = !layer->opaque;
+        out[i].transformed = layer->transformed;
+        memcpy(out[i].transform, layer->transform, sizeof(layer->transform));
+    }
+    presenter_set_layers(out, layer_count);
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    compositor_layer_t *layer = lv_display_get_user_data(disp);
+    int32_t width = lv_display_get_horizontal_resolution(disp);
+    int32_t area_width = lv_area_get_width(area);
+    int32_t area_height = lv_area_get_height(area);
+
+    // px_map is the whole layer in direct mode
+    const uint8_t *src = px_map + ((size_t)area->y1 * width + area->x1) * sizeof(lv_color32_t);
+    glBindTexture(GL_TEXTURE_2D, layer->texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, area->x1, area->y1, area_width, area_height, presenter_upload_format(),
+                    GL_UNSIGNED_BYTE, src);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    stats.uploads++;
+    stats.bytes += (uint64_t)area_width * area_height * sizeof(lv_color32_t);
+
+    if (lv_display_flush_is_last(disp)) {
+        stats.renders++;
+        damaged = true;
+    }
+    lv_display_flush_ready(disp);
+}
+
+static bool resize_layer(compositor_layer_t *layer, int32_t width, int32_t height)
+{
+    // The display keeps rendering into the old buffer until the new one exists,
+    // so a failed allocation leaves the layer, texture included, at its old size
+    uint32_t size = width * height * sizeof(lv_color32_t);
+    if (!layer->buf || !buffer_pool_fits(layer->buf_capacity, size)) {
+        size_t capacity;
+        uint8_t *buf = buffer_pool_resize(NULL, &capacity, size);
+        if (!buf)
+            return false;
+        buffer_pool_release(layer->buf, layer->buf_capacity);
+        layer->buf = buf;
+        layer->buf_capacity = capacity;
+    }
+
+    // Re-specify the texture under the same rule as the main one: only when the
+    // layer outgrew it or covers less than a quarter of it
+    int64_t capacity_px = (int64_t)layer->texture_capacity_width * layer->texture_capacity_height;
+    if (width > layer->texture_capacity_width || height > layer->texture_capacity_height ||
+        (int64_t)width * height * 4 < capacity_px) {
+        layer->texture_capacity_width = texture_capacity(width);
+        layer->texture_capacity_height = texture_capacity(height);
+        glBindTexture(GL_TEXTURE_2D, layer->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, layer->texture_capacity_width, layer->texture_capacity_height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    // The new resolution invalidates the whole layer, so it is rendered and uploaded in full
+    lv_display_set_resolution(layer->disp, width, height);
+    lv_display_set_buffers(layer->disp, layer->buf, NULL, size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    return true;
+}
+
+compositor_layer_t *compositor_create_layer(int32_t width, int32_t height, bool opaque)
+{
+    if (layer_count == COMPOSITOR_MAX_LAYERS)
+        return NULL;
+
+    compositor_layer_t *layer = &layers[layer_count];
+    memset(layer, 0, sizeof(*layer));
+    layer->opaque = opaque && layer_count == 0;  // nothing would show through from below
+
+    // lv_display_create makes the first display the default; keep the main one
+    lv_display_t *default_disp = lv_display_get_default();
+    layer->disp = lv_display_create(width, height);
+    lv_display_set_default(default_disp);
+    if (!layer->disp)
+        return NULL;
+    lv_display_set_user_data(layer->disp, layer);
+    lv_display_set_color_format(layer->disp, layer->opaque ? LV_COLOR_FORMAT_XRGB8888 : LV_COLOR_FORMAT_ARGB8888);
+    lv_display_set_flush_cb(layer->disp, flush_cb);
+
+    glGenTextures(1, &layer->texture);
+    if (!resize_layer(layer, width, height)) {
+        lv_display_delete(layer->disp);
+        glDeleteTextures(1, &layer->texture);
+        return NULL;
+    }
+
+    lv_obj_t *screen = lv_display_get_screen_active(layer->disp);
+    if (!layer->opaque)
+        lv_obj_set_style_bg_opa(screen, LV_OPA_TRANSP, 0);
+
+    layer_count++;
+    update_presenter();
+    return layer;
+}
+
+lv_obj_t *compositor_layer_get_screen(compositor_layer_t *layer)
+{
+    return lv_display_get_screen_active(layer->disp);
+}
+
+void compositor_layer_set_transform(compositor_layer_t *layer, float angle, float scale, float pivot_x,
+                                    float pivot_y)
+{
+    // Translate the pivot to the origin, rotate and scale, translate back. y grows
+    // downwards, so a positive angle turns clockwise on screen.
+    float radians = angle * 3.14159265f / 180.0f;
+    float c = cosf(radians) * scale;
+    float s = sinf(radians) * scale;
+    float *t = layer->transform;
+    t[0] = c;
+    t[1] = -s;
+    t[2] = pivot_x - c * pivot_x + s * pivot_y;
+    t[3] = s;
+    t[4] = c;
+    t[5] = pivot_y - s * pivot_x - c * pivot_y;
+    layer->transformed = angle != 0.0f || scale != 1.0f;
+
+    update_presenter();
+    damaged = true;
+}
+
+void compositor_resize(int32_t width, int32_t height)
+{
+    for (int i = 0; i < layer_count; i++)
+        resize_layer(&layers[i], width, height);
+    if (layer_count)
+        update_presenter();
+}
+
+bool compositor_take_damage(void)
+{
+    bool was_damaged = damaged;
+    damaged = false;
+    return was_damaged;
+}
+
+int compositor_layer_count(void)
+{
+    return layer_count;
+}
+
+void compositor_get_stats(compositor_stats_t *out, bool reset)
+{
+    *out = stats;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
+
+void compositor_deinit(void)
+{
+    for (int i = 0; i < layer_count; i++) {
+        lv_display_delete(layers[i].disp);
+        glDeleteTextures(1, &layers[i].texture);
+        buffer_pool_release(layers[i].buf, layers[i].buf_capacity);
+    }
+    layer_count = 0;
+    presenter_set_layers(NULL, 0);
+}
@@ -0,0 +1,57 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// Retained layers under the main LVGL display. Each layer is an LVGL display of
+// its own, rendered into its own buffer and kept in a GL texture; the presenter
+// draws the layer textures bottom up and blends the main display (which must be
+// ARGB8888 with a transparent screen) on top. A layer is only re-rendered and
+// re-uploaded when something in it is invalidated, so a label changing on the
+// main display no longer repaints e.g. a full-screen gradient behind it.
+//
+// Layers have no input device; put only content there that needs none. All
+// calls belong on the thread that owns both LVGL and the GL context.
+
+#define COMPOSITOR_MAX_LAYERS 3  // leaves room for the main texture in the presenter
+
+typedef struct compositor_layer compositor_layer_t;
+
+typedef struct {
+    uint32_t renders;       // layer frames flushed
+    uint32_t uploads;       // areas uploaded
+    uint64_t bytes;
+} compositor_stats_t;
+
+// A new layer above the existing ones and below the main display. The bottom
+// layer can be `opaque` (XRGB8888), any other has alpha (ARGB8888). Returns NULL
+// when out of layers or memory. The default display is left unchanged.
+compositor_layer_t *compositor_create_layer(int32_t width, int32_t height, bool opaque);
+
+// The layer's screen, to create its content on.
+lv_obj_t *compositor_layer_get_screen(compositor_layer_t *layer);
+
+// Draw the layer rotated by `angle` degrees (clockwise, as LVGL's transform_rotation)
+// and scaled by `scale` around the pivot, in frame pixels. The presenter applies it
+// to the layer's quad, so animating it re-renders nothing. Angle 0 and scale 1
+// restore the untransformed layer.
+void compositor_layer_set_transform(compositor_layer_t *layer, float angle, float scale, float pivot_x,
+                                    float pivot_y);
+
+// Follow a window resize: every layer takes the new resolution. A layer whose
+// buffer cannot be allocated keeps its old one, and its old resolution.
+void compositor_resize(int32_t width, int32_t height);
+
+// True once per batch of layer flushes, i.e. when the window needs presenting.
+bool compositor_take_damage(void);
+
+int compositor_layer_count(void);
+
+void compositor_get_stats(compositor_stats_t *stats, bool reset);
+
+// Delete the layers' displays and textures.
+void compositor_deinit(void);
+
+#endif // COMPOSITOR_H
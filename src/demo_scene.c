@@ -0,0 +1,97 @@
+#include "lvgl.h"
+#include "demo_scene.h"
+#include "layer_cache.h"
+#include "tiled_draw.h"
+
+void demo_scene_create_background(lv_obj_t * parent)
+{
+    static const lv_color_t grad_colors[2] = {
+        LV_COLOR_MAKE(0x9B, 0x18, 0x42),
+        LV_COLOR_MAKE(0x00, 0x00, 0x00),
+    };
+
+    int32_t width = lv_display_get_horizontal_resolution(NULL);
+    int32_t height = lv_display_get_vertical_resolution(NULL);
+
+    // Shared by every background created, so it is set up once: initializing it
+    // again would leak its properties from the LVGL heap
+    static lv_style_t style;
+    static lv_grad_dsc_t grad;
+    static bool style_ready;
+    if (!style_ready) {
+        lv_style_init(&style);
+        lv_gradient_init_stops(&grad, grad_colors, NULL, NULL, sizeof(grad_colors) / sizeof(lv_color_t));
+        lv_grad_radial_init(&grad, LV_GRAD_CENTER, LV_GRAD_CENTER, LV_GRAD_RIGHT, LV_GRAD_BOTTOM, LV_GRAD_EXTEND_PAD);
+        lv_style_set_bg_grad(&style, &grad);
+        style_ready = true;
+    }
+
+    lv_obj_t * obj = lv_obj_create(parent);
+    lv_obj_add_style(obj, &style, 0);
+    lv_obj_set_size(obj, width, height);
+    lv_obj_center(obj);
+    lv_obj_move_to_index(obj, 0);  // Move to the background
+
+#if LV_USE_OS != LV_OS_NONE && LV_DRAW_SW_DRAW_UNIT_CNT > 1
+    // One band per draw thread, otherwise the whole gradient lands on a single one
+    tiled_draw_enable(obj, LV_DRAW_SW_DRAW_UNIT_CNT);
+#endif
+}
+
+void demo_scene_create_buttons(lv_obj_t * parent)
+{
+    lv_obj_t * btn_red = lv_btn_create(parent);
+    lv_obj_align(btn_red, LV_ALIGN_CENTER, -100, 40);
+    lv_obj_set_style_bg_color(btn_red, lv_color_hex(0xFF0000), 0);
+
+    lv_obj_t * btn_green = lv_btn_create(parent);
+    lv_obj_align(btn_green, LV_ALIGN_CENTER, 0, 40);
+    lv_obj_set_style_bg_color(btn_green, lv_color_hex(0x00FF00), 0);
+
+    lv_obj_t * btn_blue = lv_btn_create(parent);
+    lv_obj_align(btn_blue, LV_ALIGN_CENTER, 100, 40);
+    lv_obj_set_style_bg_color(btn_blue, lv_color_hex(0x0000FF), 0);
+}
+
+static void fade_opa_anim_cb(void * var, int32_t value)
+{
+    lv_obj_set_style_opa_layered(var, (lv_opa_t)value, 0);
+}
+
+static void fade_x_anim_cb(void * var, int32_t value)
+{
+    lv_obj_set_x(var, value);
+}
+
+void demo_scene_create_fading_panel(lv_obj_t * parent)
+{
+    // Layered opacity draws the panel through an intermediate layer; its content never changes
+    lv_obj_t * panel = lv_obj_create(parent);
+    lv_obj_set_size(panel, 220, 110);
+    lv_obj_align(panel, LV_ALIGN_BOTTOM_MID, 0, -20);
+    lv_obj_set_style_radius(panel, 12, 0);
+    lv_obj_set_style_shadow_width(panel, 20, 0);
+    lv_obj_t * title = lv_label_create(panel);
+    lv_label_set_text(title, "Layer cache");
+    lv_obj_align(title, LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_obj_t * body = lv_label_create(panel);
+    lv_label_set_text(body, "Rendered once,\nblended every frame");
+    lv_obj_align(body, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    layer_cache_enable(panel);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, panel);
+    lv_anim_set_values(&a, LV_OPA_20, LV_OPA_COVER);
+    lv_anim_set_duration(&a, 1500);
+    lv_anim_set_playback_duration(&a, 1500);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_set_exec_cb(&a, fade_opa_anim_cb);
+    lv_anim_start(&a);
+
+    lv_anim_set_values(&a, -150, 150);
+    lv_anim_set_duration(&a, 2300);
+    lv_anim_set_playback_duration(&a, 2300);
+    lv_anim_set_exec_cb(&a, fade_x_anim_cb);
+    lv_anim_start(&a);
+}
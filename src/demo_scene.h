@@ -0,0 +1,17 @@
+#ifndef DEMO_SCENE_H
+#define DEMO_SCENE_H
+
+#include "lvgl.h"
+
+// The widgets of the example window, shared with the headless benchmark.
+
+// Radial gradient covering the display, moved behind everything else in parent.
+void demo_scene_create_background(lv_obj_t *parent);
+
+// The red, green and blue buttons below the screen center.
+void demo_scene_create_buttons(lv_obj_t *parent);
+
+// A translucent panel sliding back and forth, drawn from the layer cache.
+void demo_scene_create_fading_panel(lv_obj_t *parent);
+
+#endif // DEMO_SCENE_H
@@ -0,0 +1,70 @@
+#include "dirty_rects.h"
+
+static int64_t area_px(const lv_area_t *a)
+{
+    return (int64_t)lv_area_get_width(a) * lv_area_get_height(a);
+}
+
+static void bounding_box(lv_area_t *out, const lv_area_t *a, const lv_area_t *b)
+{
+    out->x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+    out->y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+    out->x2 = a->x2 > b->x2 ? a->x2 : b->x2;
+    out->y2 = a->y2 > b->y2 ? a->y2 : b->y2;
+}
+
+void dirty_rects_reset(dirty_rects_t *rects)
+{
+    rects->count = 0;
+}
+
+void dirty_rects_add(dirty_rects_t *rects, const lv_area_t *area)
+{
+    if (rects->count < DIRTY_RECTS_MAX) {
+        rects->areas[rects->count++] = *area;
+        return;
+    }
+
+    int best = 0;
+    int64_t best_growth = INT64_MAX;
+    for (int i = 0; i < rects->count; i++) {
+        lv_area_t joined;
+        bounding_box(&joined, &rects->areas[i], area);
+        int64_t growth = area_px(&joined) - area_px(&rects->areas[i]);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    bounding_box(&rects->areas[best], &rects->areas[best], area);
+}
+
+void dirty_rects_coalesce(dirty_rects_t *rects, uint32_t overhead_px)
+{
+    for (;;) {
+        int best_i = -1;
+        int best_j = -1;
+        int64_t best_saving = -1;
+
+        // cost(rect) = overhead + pixels; merge when cost(a) + cost(b) >= cost(bbox)
+        for (int i = 0; i < rects->count; i++) {
+            for (int j = i + 1; j < rects->count; j++) {
+                lv_area_t joined;
+                bounding_box(&joined, &rects->areas[i], &rects->areas[j]);
+                int64_t saving = area_px(&rects->areas[i]) + area_px(&rects->areas[j]) +
+                                 overhead_px - area_px(&joined);
+                if (saving > best_saving) {
+                    best_saving = saving;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+
+        if (best_i < 0)
+            return;
+
+        bounding_box(&rects->areas[best_i], &rects->areas[best_i], &rects->areas[best_j]);
+        rects->areas[best_j] = rects->areas[--rects->count];
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef DIRTY_RECTS_H
+#define DIRTY_RECTS_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+#define DIRTY_RECTS_MAX 32
+
+// Fixed cost of one upload (bind, pixel store setup, driver call) expressed in
+// pixels, so it can be weighed against the extra pixels a merged bounding box
+// would copy. 64x64 is a starting point; the app exposes it as an option.
+#define DIRTY_RECTS_DEFAULT_OVERHEAD_PX 4096
+
+// Areas collected over one refresh.
+typedef struct {
+    lv_area_t areas[DIRTY_RECTS_MAX];
+    int count;
+} dirty_rects_t;
+
+void dirty_rects_reset(dirty_rects_t *rects);
+
+// Add an area. When the list is full the area is merged into the rectangle that
+// grows the least, so nothing is ever dropped.
+void dirty_rects_add(dirty_rects_t *rects, const lv_area_t *area);
+
+// Greedily merge pairs whose bounding box is cheaper to upload than the two
+// rectangles separately, until no merge pays off: a pair qualifies when the
+// bounding box has at most `overhead_px` more pixels than the two rectangles
+// together. Overlapping or adjacent rectangles of very different shape (e.g.
+// 1000x1000 and 1000x1 sharing a corner) can still stay apart.
+void dirty_rects_coalesce(dirty_rects_t *rects, uint32_t overhead_px);
+
+#endif // DIRTY_RECTS_H
@@ -0,0 +1,53 @@
+#include "event_queue.h"
+
+void event_queue_init(event_queue_t *queue)
+{
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->dropped, 0);
+}
+
+bool event_queue_push(event_queue_t *queue, const app_event_t *event)
+{
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail == EVENT_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    queue->events[head & (EVENT_QUEUE_SIZE - 1)] = *event;
+    // Publish the slot contents before the new head
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool event_queue_pop(event_queue_t *queue, app_event_t *event)
+{
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    *event = queue->events[tail & (EVENT_QUEUE_SIZE - 1)];
+    // Hand the slot back only after it has been copied out
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool event_queue_peek(event_queue_t *queue, app_event_t *event)
+{
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    *event = queue->events[tail & (EVENT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+bool event_queue_is_empty(event_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->tail, memory_order_relaxed) ==
+           atomic_load_explicit(&queue->head, memory_order_acquire);
+}
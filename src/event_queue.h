@@ -0,0 +1,47 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EVENT_QUEUE_SIZE 256  // power of two
+
+typedef enum {
+    APP_EVENT_POINTER,      // motion: x, y in frame coordinates, pressed = left button state
+    APP_EVENT_BUTTON,       // the left button went down or up (pressed) at x, y
+    APP_EVENT_SCROLL,       // y = wheel steps, positive away from the user
+    APP_EVENT_KEY,          // key = LVGL key or Unicode character, pressed
+    APP_EVENT_RESIZE,       // x, y = new framebuffer width and height
+} app_event_type_t;
+
+typedef struct {
+    app_event_type_t type;
+    int32_t x;
+    int32_t y;
+    uint32_t key;
+    bool pressed;
+    uint32_t timestamp;     // [ms] on LVGL's tick clock, when GLFW reported it
+    double time;            // [s] the same moment at full glfwGetTime resolution
+} app_event_t;
+
+// Single-producer/single-consumer ring: GLFW callbacks push on the main thread,
+// the LVGL thread pops. Neither side ever blocks.
+typedef struct {
+    app_event_t events[EVENT_QUEUE_SIZE];
+    atomic_uint head;       // next slot to write, only advanced by the producer
+    atomic_uint tail;       // next slot to read, only advanced by the consumer
+    atomic_uint dropped;
+} event_queue_t;
+
+void event_queue_init(event_queue_t *queue);
+
+// Returns false (and counts a drop) if the consumer has fallen a whole ring behind.
+bool event_queue_push(event_queue_t *queue, const app_event_t *event);
+bool event_queue_pop(event_queue_t *queue, app_event_t *event);
+
+// Consumer: the event event_queue_pop would return next, left in the queue.
+bool event_queue_peek(event_queue_t *queue, app_event_t *event);
+bool event_queue_is_empty(event_queue_t *queue);
+
+#endif // EVENT_QUEUE_H
@@ -0,0 +1,108 @@
+#include <stdatomic.h>
+#include <string.h>
+#include "frame_exchange.h"
+#include "buffer_pool.h"
+
+#define SLOT_COUNT 3
+#define SLOT_MASK 3u
+#define FRESH 4u    // set in `middle` while it holds a frame the consumer has not taken
+
+static exchange_frame_t slots[SLOT_COUNT];
+static unsigned back;           // owned by the producer
+static unsigned front;          // owned by the consumer
+static atomic_uint middle;      // slot index | FRESH, swapped by both sides
+static dirty_rects_t pending;   // producer: damage the consumer may not have received yet
+static uint32_t sequence;       // producer
+
+static atomic_uint published;
+static atomic_uint acquired;
+static atomic_uint replaced;
+
+void frame_exchange_init(void)
+{
+    memset(slots, 0, sizeof(slots));
+    back = 0;
+    atomic_init(&middle, 1);
+    front = 2;
+    dirty_rects_reset(&pending);
+    sequence = 0;
+    atomic_init(&published, 0);
+    atomic_init(&acquired, 0);
+    atomic_init(&replaced, 0);
+}
+
+void frame_exchange_deinit(void)
+{
+    for (int i = 0; i < SLOT_COUNT; i++)
+        buffer_pool_release(slots[i].pixels, slots[i].capacity);
+    memset(slots, 0, sizeof(slots));
+}
+
+static void copy_area(exchange_frame_t *frame, const lv_area_t *area, const uint8_t *px_map, int32_t stride)
+{
+    int32_t row_bytes = lv_area_get_width(area) * 4;
+    int32_t frame_stride = frame->width * 4;
+    for (int32_t y = area->y1; y <= area->y2; y++)
+        memcpy(frame->pixels + y * frame_stride + area->x1 * 4, px_map + y * stride + area->x1 * 4, row_bytes);
+}
+
+void frame_exchange_publish(const uint8_t *px_map, int32_t width, int32_t height, int32_t stride,
+                            const dirty_rects_t *damage)
+{
+    exchange_frame_t *frame = &slots[back];
+    frame->pixels = buffer_pool_resize(frame->pixels, &frame->capacity, (size_t)width * height * 4);
+    frame->width = width;
+    frame->height = height;
+    frame->sequence = ++sequence;
+
+    // Only the producer sets FRESH, so once the consumer has taken the last frame
+    // everything before it is known to have arrived. Until then the damage keeps
+    // accumulating, as this frame may replace ones the consumer never saw.
+    if (!(atomic_load_explicit(&middle, memory_order_relaxed) & FRESH))
+        dirty_rects_reset(&pending);
+    for (int i = 0; i < damage->count; i++)
+        dirty_rects_add(&pending, &damage->areas[i]);
+
+    lv_area_t screen = { 0, 0, width - 1, height - 1 };
+    dirty_rects_reset(&frame->rects);
+    for (int i = 0; i < pending.count; i++) {
+        lv_area_t area;
+        if (!lv_area_intersect(&area, &pending.areas[i], &screen))
+            continue;  // left over from before a resize
+        copy_area(frame, &area, px_map, stride);
+        dirty_rects_add(&frame->rects, &area);
+    }
+
+    // The release half publishes the pixels; the acquire half makes the returned
+    // slot's last use by the consumer visible before it is overwritten
+    unsigned prev = atomic_exchange_explicit(&middle, back | FRESH, memory_order_acq_rel);
+    back = prev & SLOT_MASK;
+    atomic_fetch_add_explicit(&published, 1, memory_order_relaxed);
+    if (prev & FRESH)
+        atomic_fetch_add_explicit(&replaced, 1, memory_order_relaxed);
+}
+
+const exchange_frame_t *frame_exchange_acquire(void)
+{
+    if (!(atomic_load_explicit(&middle, memory_order_acquire) & FRESH))
+        return NULL;
+
+    unsigned prev = atomic_exchange_explicit(&middle, front, memory_order_acq_rel);
+    front = prev & SLOT_MASK;
+    atomic_fetch_add_explicit(&acquired, 1, memory_order_relaxed);
+    return &slots[front];
+}
+
+void frame_exchange_get_stats(frame_exchange_stats_t *out, bool reset)
+{
+    if (reset) {
+        out->published = atomic_exchange(&published, 0);
+        out->acquired = atomic_exchange(&acquired, 0);
+        out->replaced = atomic_exchange(&replaced, 0);
+    }
+    else {
+        out->published = atomic_load(&published);
+        out->acquired = atomic_load(&acquired);
+        out->replaced = atomic_load(&replaced);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef FRAME_EXCHANGE_H
+#define FRAME_EXCHANGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dirty_rects.h"
+
+// Lock-free triple buffer between the LVGL thread (producer) and the GL thread
+// (consumer). The producer always has a slot to write, the consumer always gets
+// the newest finished frame and neither waits for the other. A frame carries
+// only the pixels of its damaged areas; the consumer applies them to its own
+// copy (the texture). When the producer replaces a frame the consumer never
+// took, that frame's damage is carried into the next one, so nothing is lost.
+
+typedef struct {
+    uint8_t *pixels;        // XRGB8888, width * 4 bytes per row; valid inside `rects` only
+    int32_t width;
+    int32_t height;
+    size_t capacity;
+    dirty_rects_t rects;    // changed since the previous frame the consumer acquired
+    uint32_t sequence;      // frames published up to and including this one
+} exchange_frame_t;
+
+typedef struct {
+    uint32_t published;
+    uint32_t acquired;
+    uint32_t replaced;      // published but overwritten before the consumer took them
+} frame_exchange_stats_t;
+
+// Call with neither thread using the exchange.
+void frame_exchange_init(void);
+void frame_exchange_deinit(void);
+
+// Producer: copy the damaged areas of a finished frame and make it the newest.
+void frame_exchange_publish(const uint8_t *px_map, int32_t width, int32_t height, int32_t stride,
+                            const dirty_rects_t *damage);
+
+// Consumer: the newest frame if one was published since the last call, else
+// NULL. The frame stays valid until the next call.
+const exchange_frame_t *frame_exchange_acquire(void);
+
+void frame_exchange_get_stats(frame_exchange_stats_t *stats, bool reset);
+
+#endif // FRAME_EXCHANGE_H
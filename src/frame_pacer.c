@@ -0,0 +1,187 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "gl_ext.h"
+#include "frame_pacer.h"
+
+#define DEFAULT_HZ 60.0
+#define CONTINUOUS_PERIODS 4    // a longer gap between swaps is idle time, not a frame interval
+#define PERIOD_SMOOTHING 16.0
+
+static GLFWwindow *window;
+static frame_pacer_vsync_t vsync;
+static double period;           // [s] between vblanks
+static double vblank;           // [s] the last swap seen returning at a vblank, 0 until then
+static double costs[FRAME_PACER_COST_SAMPLES];
+static int cost_count;
+static int cost_next;
+static double begin_time;
+static double target;           // [s] the vblank the current frame is meant for, 0 if unknown
+static double slot;             // [s] the vblank frame_pacer_wait_for_slot waited for
+static double last_present;
+
+static struct {
+    uint32_t frames;
+    uint32_t missed;
+    uint32_t intervals;
+    double interval_sum;
+    double interval_min;
+    double interval_max;
+    uint32_t costs;
+    double cost_sum;
+    double cost_max;
+    double jit_wait;
+} stats;
+
+static const char *const vsync_names[] = { "off", "on", "adaptive" };
+
+void frame_pacer_init(GLFWwindow *win, frame_pacer_vsync_t mode)
+{
+    window = win;
+    if (mode == FRAME_PACER_VSYNC_ADAPTIVE && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        fprintf(stderr, "Adaptive vsync is not supported here, using vsync on\n");
+        mode = FRAME_PACER_VSYNC_ON;
+    }
+    vsync = mode;
+    glfwSwapInterval(mode == FRAME_PACER_VSYNC_ADAPTIVE ? -1 : mode == FRAME_PACER_VSYNC_ON ? 1 : 0);
+
+    // Windowed, GLFW reports no monitor for the window; the primary one is the best guess
+    GLFWmonitor *monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode *mode_info = monitor ? glfwGetVideoMode(monitor) : NULL;
+    period = 1.0 / (mode_info && mode_info->refreshRate > 0 ? mode_info->refreshRate : DEFAULT_HZ);
+
+    vblank = 0.0;
+    target = 0.0;
+    slot = 0.0;
+    last_present = 0.0;
+    cost_count = 0;
+    cost_next = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+frame_pacer_vsync_t frame_pacer_get_vsync(void)
+{
+    return vsync;
+}
+
+const char *frame_pacer_vsync_name(frame_pacer_vsync_t mode)
+{
+    return vsync_names[mode];
+}
+
+bool frame_pacer_parse_vsync(const char *name, frame_pacer_vsync_t *mode)
+{
+    for (int i = 0; i < (int)(sizeof(vsync_names) / sizeof(vsync_names[0])); i++) {
+        if (strcmp(name, vsync_names[i]) == 0) {
+            *mode = (frame_pacer_vsync_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The worst of the recent frames plus a margin: one slow frame in a few
+// is what a deadline has to survive
+static double predicted_cost(void)
+{
+    double cost = 0.0;
+    for (int i = 0; i < cost_count; i++)
+        cost = fmax(cost, costs[i]);
+    return cost + FRAME_PACER_MARGIN_MS / 1000.0;
+}
+
+// The first vblank at or after `t`, 0 while the phase is unknown
+static double vblank_after(double t)
+{
+    if (vsync == FRAME_PACER_VSYNC_OFF || vblank == 0.0)
+        return 0.0;
+    return vblank + ceil((t - vblank) / period) * period;
+}
+
+void frame_pacer_wait_for_slot(void)
+{
+    double now = glfwGetTime();
+    double cost = predicted_cost();
+    double next = vblank_after(now + cost);
+    if (next == 0.0)
+        return;
+
+    // Input arriving meanwhile is queued by the GLFW callbacks and handled at the start
+    double start = next - cost;
+    slot = next;
+    while (now < start && !glfwWindowShouldClose(window)) {
+        glfwWaitEventsTimeout(start - now);
+        double woke = glfwGetTime();
+        stats.jit_wait += woke - now;
+        now = woke;
+    }
+}
+
+void frame_pacer_begin(void)
+{
+    begin_time = glfwGetTime();
+    target = slot > begin_time ? slot : vblank_after(begin_time + predicted_cost());
+    slot = 0.0;
+}
+
+void frame_pacer_swap(void)
+{
+    double submit_time = glfwGetTime();
+    LV_PROFILER_BEGIN_TAG("glfwSwapBuffers");
+    glfwSwapBuffers(window);
+    if (vsync != FRAME_PACER_VSYNC_OFF)
+        glFinish();  // returns once the swap happened, at the vblank
+    LV_PROFILER_END_TAG("glfwSwapBuffers");
+
+    double now = glfwGetTime();
+    stats.frames++;
+
+    double cost = submit_time - begin_time;
+    costs[cost_next] = cost;
+    cost_next = (cost_next + 1) % FRAME_PACER_COST_SAMPLES;
+    if (cost_count < FRAME_PACER_COST_SAMPLES)
+        cost_count++;
+    stats.costs++;
+    stats.cost_sum += cost;
+    stats.cost_max = fmax(stats.cost_max, cost);
+
+    double interval = now - last_present;
+    if (last_present > 0.0 && interval < CONTINUOUS_PERIODS * period) {
+        stats.intervals++;
+        stats.interval_sum += interval;
+        stats.interval_min = stats.intervals == 1 ? interval : fmin(stats.interval_min, interval);
+        stats.interval_max = fmax(stats.interval_max, interval);
+
+        // Follow the real refresh rate, skipping intervals that are not whole periods
+        double periods = round(interval / period);
+        if (vsync != FRAME_PACER_VSYNC_OFF && periods >= 1.0 && fabs(interval - periods * period) < 0.25 * period)
+            period += (interval / periods - period) / PERIOD_SMOOTHING;
+    }
+    last_present = now;
+
+    bool missed = target > 0.0 && now > target + period / 2;
+    if (missed)
+        stats.missed++;
+
+    // A late swap with adaptive vsync tears right away instead of waiting for a vblank
+    if (vsync == FRAME_PACER_VSYNC_ON || (vsync == FRAME_PACER_VSYNC_ADAPTIVE && !missed))
+        vblank = now;
+}
+
+void frame_pacer_get_stats(frame_pacer_stats_t *out, bool reset)
+{
+    out->frames = stats.frames;
+    out->missed = stats.missed;
+    out->intervals = stats.intervals;
+    out->interval_avg = stats.intervals ? stats.interval_sum * 1000.0 / stats.intervals : 0.0;
+    out->interval_min = stats.interval_min * 1000.0;
+    out->interval_max = stats.interval_max * 1000.0;
+    out->refresh_hz = 1.0 / period;
+    out->cost_avg = stats.costs ? stats.cost_sum * 1000.0 / stats.costs : 0.0;
+    out->cost_max = stats.cost_max * 1000.0;
+    out->jit_wait_ms = stats.jit_wait * 1000.0;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,60 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <GLFW/glfw3.h>
+
+// Vsync control and frame timing for the main loop. With vsync on the loop
+// waits for each swap to complete, so the time a swap returns is the vblank it
+// was shown at: from those the pacer tracks the refresh period and phase, and
+// the driver never queues frames ahead of the one being drawn.
+//
+// Just-in-time mode starts each frame as late as the recent render cost allows
+// before the predicted vblank, so input and animations are sampled as close to
+// the display as possible. A frame that ends up shown after the vblank it was
+// started for counts as a missed deadline.
+
+typedef enum {
+    FRAME_PACER_VSYNC_OFF,
+    FRAME_PACER_VSYNC_ON,
+    FRAME_PACER_VSYNC_ADAPTIVE,     // tear instead of waiting a whole period when late
+} frame_pacer_vsync_t;
+
+#define FRAME_PACER_COST_SAMPLES 16     // frames the render cost prediction looks back
+#define FRAME_PACER_MARGIN_MS 1.0       // added to the predicted cost
+
+typedef struct {
+    uint32_t frames;        // swaps
+    uint32_t missed;        // shown after the vblank they were started for
+    uint32_t intervals;     // swaps less than a few periods after the previous one
+    double interval_avg;    // [ms] between those swaps
+    double interval_min;
+    double interval_max;
+    double refresh_hz;      // measured (the monitor's until vsync gives samples)
+    double cost_avg;        // [ms] frame start until the swap was issued
+    double cost_max;
+    double jit_wait_ms;     // slept to start frames just in time
+} frame_pacer_stats_t;
+
+// Main thread with the context current. Adaptive vsync falls back to on where
+// the swap_control_tear extension is missing.
+void frame_pacer_init(GLFWwindow *window, frame_pacer_vsync_t vsync);
+frame_pacer_vsync_t frame_pacer_get_vsync(void);
+const char *frame_pacer_vsync_name(frame_pacer_vsync_t vsync);
+bool frame_pacer_parse_vsync(const char *name, frame_pacer_vsync_t *vsync);
+
+// Sleep until the latest start that still makes the next reachable vblank,
+// running GLFW callbacks meanwhile. Returns at once with vsync off.
+void frame_pacer_wait_for_slot(void);
+
+// Call before the work that may end in a swap; an iteration that does not swap
+// is simply begun again.
+void frame_pacer_begin(void);
+
+// glfwSwapBuffers, with vsync waiting for the swap to complete (glFinish).
+void frame_pacer_swap(void);
+
+void frame_pacer_get_stats(frame_pacer_stats_t *stats, bool reset);
+
+#endif // FRAME_PACER_H
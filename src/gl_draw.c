@@ -0,0 +1,580 @@
+#include <string.h>
+#include "lvgl.h"
+#include "lvgl_private.h"  // lv_draw_unit_t, lv_draw_task_t, lv_layer_t internals
+#include "gl_draw.h"
+#include "gl_shader.h"
+
+#define DRAW_UNIT_ID_GL 20      // clear of the ids LVGL's own units use
+#define GL_DRAW_PREFERENCE 80   // the SW unit rates everything 100, lower wins
+#define GL_DRAW_MAX_STOPS 4
+#define ATTRIB_POS 0
+
+typedef enum {
+    SHAPE_FILL,
+    SHAPE_BORDER,
+    SHAPE_IMAGE,
+} shape_t;
+
+typedef enum {
+    GRAD_NONE,
+    GRAD_VER,
+    GRAD_HOR,
+    GRAD_RADIAL,
+} grad_t;
+
+static const char *vertex_src =
+    "ATTRIBUTE vec2 a_pos;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(a_pos, 0.0, 1.0);\n"
+    "}\n";
+
+// Coordinates are LVGL's: y grows downwards and pixel (x, y) covers [x, x + 1).
+// The FBO holds the task's area with its first row at the bottom of the texture,
+// so gl_FragCoord maps onto the layer without a flip.
+static const char *fragment_src =
+    "uniform vec2 u_origin;\n"
+    "uniform int u_shape;\n"
+    "uniform vec4 u_rect;\n"
+    "uniform float u_radius;\n"
+    "uniform vec4 u_inner_rect;\n"
+    "uniform float u_inner_radius;\n"
+    "uniform vec4 u_color;\n"
+    "uniform int u_grad;\n"
+    "uniform int u_stop_count;\n"
+    "uniform vec4 u_stop_color[4];\n"
+    "uniform float u_stop_pos[4];\n"
+    "uniform vec4 u_radial;  // centre x, y and radius\n"
+    "uniform int u_extend;\n"
+    "uniform sampler2D u_image;\n"
+    "uniform vec2 u_image_size;\n"
+    "uniform float u_image_alpha;\n"
+    "\n"
+    "float box_coverage(vec2 p, vec4 rect, float radius) {\n"
+    "    vec2 half_size = (rect.zw - rect.xy) * 0.5;\n"
+    "    vec2 q = abs(p - rect.xy - half_size) - half_size + radius;\n"
+    "    float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;\n"
+    "    return clamp(0.5 - d, 0.0, 1.0);\n"
+    "}\n"
+    "\n"
+    "vec4 gradient(vec2 px) {\n"
+    "    float pos;\n"
+    "    if (u_grad == 1)\n"
+    "        pos = px.y;\n"
+    "    else if (u_grad == 2)\n"
+    "        pos = px.x;\n"
+    "    else {\n"
+    "        float t = length(px - u_radial.xy) / u_radial.z;\n"
+    "        if (u_extend == 1)\n"
+    "            t = fract(t);\n"
+    "        else if (u_extend == 2)\n"
+    "            t = 1.0 - abs(mod(t, 2.0) - 1.0);\n"
+    "        pos = t * 255.0;\n"
+    "    }\n"
+    "    vec4 c = u_stop_color[0];\n"
+    "    for (int i = 1; i < 4; i++) {\n"
+    "        if (i < u_stop_count && pos > u_stop_pos[i - 1]) {\n"
+    "            float span = max(u_stop_pos[i] - u_stop_pos[i - 1], 0.0001);\n"
+    "            c = mix(u_stop_color[i - 1], u_stop_color[i], clamp((pos - u_stop_pos[i - 1]) / span, 0.0, 1.0));\n"
+    "        }\n"
+    "    }\n"
+    "    return c;\n"
+    "}\n"
+    "\n"
+    "void main() {\n"
+    "    vec2 p = u_origin + gl_FragCoord.xy;\n"
+    "    float coverage = box_coverage(p, u_rect, u_radius);\n"
+    "    vec4 color = u_color;\n"
+    "    if (u_shape == 1) {\n"
+    "        coverage *= 1.0 - box_coverage(p, u_inner_rect, u_inner_radius);\n"
+    "    }\n"
+    "    else if (u_shape == 2) {\n"
+    "        vec4 texel = TEXTURE(u_image, (p - u_rect.xy) / u_image_size);\n"
+    "        color = vec4(texel.rgb, mix(1.0, texel.a, u_image_alpha) * u_color.a);\n"
+    "    }\n"
+    "    else if (u_grad != 0) {\n"
+    "        vec4 g = gradient(floor(p - u_rect.xy));\n"
+    "        color = vec4(g.rgb, g.a * u_color.a);\n"
+    "    }\n"
+    "    FRAG_COLOR = vec4(color.rgb, color.a * coverage);\n"
+    "}\n";
+
+static const GLfloat quad[] = {
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+    -1.0f,  1.0f,
+     1.0f,  1.0f,
+};
+
+static struct {
+    GLint origin;
+    GLint shape;
+    GLint rect;
+    GLint radius;
+    GLint inner_rect;
+    GLint inner_radius;
+    GLint color;
+    GLint grad;
+    GLint stop_count;
+    GLint stop_color;
+    GLint stop_pos;
+    GLint radial;
+    GLint extend;
+    GLint image;
+    GLint image_size;
+    GLint image_alpha;
+} uniforms;
+
+static lv_draw_unit_t *unit;
+static bool enabled;
+static GLuint program;
+static GLuint vao;
+static GLuint vbo;
+static GLuint fbo;
+static GLuint fbo_texture;
+static int32_t fbo_width;
+static int32_t fbo_height;
+static GLuint image_texture;
+static gl_draw_stats_t stats;
+
+static float opa_to_float(lv_opa_t opa)
+{
+    // LVGL treats anything above LV_OPA_MAX as fully opaque
+    return opa >= LV_OPA_MAX ? 1.0f : opa / 255.0f;
+}
+
+static int32_t clamp_radius(int32_t radius, const lv_area_t *coords)
+{
+    int32_t short_side = LV_MIN(lv_area_get_width(coords), lv_area_get_height(coords));
+    return LV_MIN(radius, short_side / 2);
+}
+
+static void set_rect_uniform(GLint location, const lv_area_t *area)
+{
+    gl_ext.Uniform4f(location, (GLfloat)area->x1, (GLfloat)area->y1, (GLfloat)(area->x2 + 1),
+                     (GLfloat)(area->y2 + 1));
+}
+
+#if LV_USE_DRAW_SW_COMPLEX_GRADIENTS
+// Only radial gradients centred on their focal point (what lv_grad_radial_init
+// sets up) are drawn here; their parameter is simply distance / radius.
+static bool resolve_radial(const lv_grad_dsc_t *grad, const lv_area_t *coords, GLfloat out[3])
+{
+    int32_t w = lv_area_get_width(coords);
+    int32_t h = lv_area_get_height(coords);
+    int32_t cx = lv_pct_to_px(grad->params.radial.end.x, w);
+    int32_t cy = lv_pct_to_px(grad->params.radial.end.y, h);
+    int32_t ex = lv_pct_to_px(grad->params.radial.end_extent.x, w);
+    int32_t ey = lv_pct_to_px(grad->params.radial.end_extent.y, h);
+
+    if (lv_pct_to_px(grad->params.radial.focal.x, w) != cx ||
+        lv_pct_to_px(grad->params.radial.focal.y, h) != cy ||
+        lv_pct_to_px(grad->params.radial.focal_extent.x, w) != cx ||
+        lv_pct_to_px(grad->params.radial.focal_extent.y, h) != cy)
+        return false;
+
+    uint32_t radius = lv_sqrt32((uint32_t)((ex - cx) * (ex - cx) + (ey - cy) * (ey - cy)));
+    if (radius == 0)
+        return false;
+
+    if (out) {
+        out[0] = (GLfloat)cx;
+        out[1] = (GLfloat)cy;
+        out[2] = (GLfloat)radius;
+    }
+    return true;
+}
+#endif
+
+static bool can_draw_grad(const lv_grad_dsc_t *grad, const lv_area_t *coords)
+{
+    switch (grad->dir) {
+    case LV_GRAD_DIR_NONE:
+        return true;
+    case LV_GRAD_DIR_VER:
+    case LV_GRAD_DIR_HOR:
+        return grad->stops_count >= 2 && grad->stops_count <= GL_DRAW_MAX_STOPS;
+#if LV_USE_DRAW_SW_COMPLEX_GRADIENTS
+    case LV_GRAD_DIR_RADIAL:
+        return grad->stops_count >= 2 && grad->stops_count <= GL_DRAW_MAX_STOPS &&
+               resolve_radial(grad, coords, NULL);
+#endif
+    default:
+        return false;
+    }
+}
+
+static bool can_draw_image(const lv_draw_image_dsc_t *dsc, const lv_area_t *coords)
+{
+    if (lv_image_src_get_type(dsc->src) != LV_IMAGE_SRC_VARIABLE)
+        return false;
+
+    const lv_image_dsc_t *img = dsc->src;
+    if (img->header.cf != LV_COLOR_FORMAT_ARGB8888 && img->header.cf != LV_COLOR_FORMAT_XRGB8888)
+        return false;
+
+    // Anything that changes the pixels beyond a straight blit goes to the SW unit
+    return dsc->rotation == 0 && dsc->scale_x == LV_SCALE_NONE && dsc->scale_y == LV_SCALE_NONE &&
+           dsc->skew_x == 0 && dsc->skew_y == 0 && dsc->recolor_opa <= LV_OPA_MIN && !dsc->tile &&
+           dsc->clip_radius == 0 && dsc->bitmap_mask_src == NULL && dsc->blend_mode == LV_BLEND_MODE_NORMAL &&
+           lv_area_get_width(coords) == img->header.w && lv_area_get_height(coords) == img->header.h;
+}
+
+static bool can_draw(const lv_draw_task_t *t)
+{
+    switch (t->type) {
+    case LV_DRAW_TASK_TYPE_FILL: {
+        const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+        return can_draw_grad(&dsc->grad, &t->area);
+    }
+    case LV_DRAW_TASK_TYPE_BORDER: {
+        const lv_draw_border_dsc_t *dsc = t->draw_dsc;
+        return dsc->side == LV_BORDER_SIDE_FULL;
+    }
+    case LV_DRAW_TASK_TYPE_IMAGE:
+        return can_draw_image(t->draw_dsc, &t->area);
+    default:
+        return false;
+    }
+}
+
+static void set_grad_uniforms(const lv_grad_dsc_t *grad, const lv_area_t *coords, float opa)
+{
+    grad_t mode = GRAD_NONE;
+    int32_t range = 256;  // radial gradients are looked up over 0..255
+
+    if (grad->dir == LV_GRAD_DIR_VER) {
+        mode = GRAD_VER;
+        range = lv_area_get_height(coords);
+    }
+    else if (grad->dir == LV_GRAD_DIR_HOR) {
+        mode = GRAD_HOR;
+        range = lv_area_get_width(coords);
+    }
+#if LV_USE_DRAW_SW_COMPLEX_GRADIENTS
+    else if (grad->dir == LV_GRAD_DIR_RADIAL) {
+        GLfloat radial[3];
+        resolve_radial(grad, coords, radial);
+        mode = GRAD_RADIAL;
+        gl_ext.Uniform4f(uniforms.radial, radial[0], radial[1], radial[2], 0.0f);
+        gl_ext.Uniform1i(uniforms.extend, grad->extend == LV_GRAD_EXTEND_REPEAT ? 1 :
+                                          grad->extend == LV_GRAD_EXTEND_REFLECT ? 2 : 0);
+    }
+#endif
+
+    gl_ext.Uniform1i(uniforms.grad, mode);
+    if (mode == GRAD_NONE)
+        return;
+
+    GLfloat colors[GL_DRAW_MAX_STOPS * 4];
+    GLfloat positions[GL_DRAW_MAX_STOPS];
+    for (int i = 0; i < grad->stops_count; i++) {
+        const lv_grad_stop_t *stop = &grad->stops[i];
+        colors[i * 4 + 0] = stop->color.red / 255.0f;
+        colors[i * 4 + 1] = stop->color.green / 255.0f;
+        colors[i * 4 + 2] = stop->color.blue / 255.0f;
+        colors[i * 4 + 3] = opa_to_float(stop->opa);
+        positions[i] = (GLfloat)((stop->frac * range) >> 8);  // as lv_gradient_color_calculate places them
+    }
+    gl_ext.Uniform1i(uniforms.stop_count, grad->stops_count);
+    gl_ext.Uniform4fv(uniforms.stop_color, grad->stops_count, colors);
+    gl_ext.Uniform1fv(uniforms.stop_pos, grad->stops_count, positions);
+    gl_ext.Uniform4f(uniforms.color, 1.0f, 1.0f, 1.0f, opa);
+}
+
+// Set the uniforms for one task. Returns false if there is nothing to draw.
+static bool set_task_uniforms(const lv_draw_task_t *t)
+{
+    set_rect_uniform(uniforms.rect, &t->area);
+
+    if (t->type == LV_DRAW_TASK_TYPE_FILL) {
+        const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+        if (dsc->opa <= LV_OPA_MIN)
+            return false;
+        gl_ext.Uniform1i(uniforms.shape, SHAPE_FILL);
+        gl_ext.Uniform1f(uniforms.radius, (GLfloat)clamp_radius(dsc->radius, &t->area));
+        gl_ext.Uniform4f(uniforms.color, dsc->color.red / 255.0f, dsc->color.green / 255.0f,
+                         dsc->color.blue / 255.0f, opa_to_float(dsc->opa));
+        set_grad_uniforms(&dsc->grad, &t->area, opa_to_float(dsc->opa));
+        stats.fills++;
+        return true;
+    }
+
+    if (t->type == LV_DRAW_TASK_TYPE_BORDER) {
+        const lv_draw_border_dsc_t *dsc = t->draw_dsc;
+        if (dsc->opa <= LV_OPA_MIN || dsc->width <= 0)
+            return false;
+
+        int32_t radius = clamp_radius(dsc->radius, &t->area);
+        lv_area_t inner = t->area;
+        inner.x1 += dsc->width;
+        inner.y1 += dsc->width;
+        inner.x2 -= dsc->width;
+        inner.y2 -= dsc->width;
+        gl_ext.Uniform1i(uniforms.shape, SHAPE_BORDER);
+        gl_ext.Uniform1i(uniforms.grad, GRAD_NONE);
+        gl_ext.Uniform1f(uniforms.radius, (GLfloat)radius);
+        if (inner.x1 > inner.x2 || inner.y1 > inner.y2) {
+            // The border is wider than the shape: nothing is cut out
+            gl_ext.Uniform4f(uniforms.inner_rect, -1e6f, -1e6f, -1e6f, -1e6f);
+            gl_ext.Uniform1f(uniforms.inner_radius, 0.0f);
+        }
+        else {
+            set_rect_uniform(uniforms.inner_rect, &inner);
+            gl_ext.Uniform1f(uniforms.inner_radius, (GLfloat)LV_MAX(radius - dsc->width, 0));
+        }
+        gl_ext.Uniform4f(uniforms.color, dsc->color.red / 255.0f, dsc->color.green / 255.0f,
+                         dsc->color.blue / 255.0f, opa_to_float(dsc->opa));
+        stats.borders++;
+        return true;
+    }
+
+    const lv_draw_image_dsc_t *dsc = t->draw_dsc;
+    const lv_image_dsc_t *img = dsc->src;
+    if (dsc->opa <= LV_OPA_MIN)
+        return false;
+
+    uint32_t stride = img->header.stride ? img->header.stride : img->header.w * 4;
+    glBindTexture(GL_TEXTURE_2D, image_texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, img->header.w, img->header.h, 0, GL_BGRA, GL_UNSIGNED_BYTE,
+                 img->data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    gl_ext.Uniform1i(uniforms.shape, SHAPE_IMAGE);
+    gl_ext.Uniform1i(uniforms.grad, GRAD_NONE);
+    gl_ext.Uniform1f(uniforms.radius, 0.0f);
+    gl_ext.Uniform2f(uniforms.image_size, (GLfloat)img->header.w, (GLfloat)img->header.h);
+    gl_ext.Uniform1f(uniforms.image_alpha, img->header.cf == LV_COLOR_FORMAT_ARGB8888 ? 1.0f : 0.0f);
+    gl_ext.Uniform4f(uniforms.color, 1.0f, 1.0f, 1.0f, opa_to_float(dsc->opa));
+    stats.images++;
+    return true;
+}
+
+static bool ensure_fbo(int32_t width, int32_t height)
+{
+    if (width <= fbo_width && height <= fbo_height)
+        return true;
+
+    // Grow in steps so a few differently sized tasks don't reallocate every time
+    fbo_width = LV_MAX(fbo_width, (width + 255) & ~255);
+    fbo_height = LV_MAX(fbo_height, (height + 255) & ~255);
+    glBindTexture(GL_TEXTURE_2D, fbo_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, fbo_width, fbo_height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl_ext.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fbo_texture, 0);
+    bool complete = gl_ext.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+        fbo_width = fbo_height = 0;
+    return complete;
+}
+
+static void draw_task(lv_layer_t *layer, const lv_draw_task_t *t)
+{
+    lv_area_t area;
+    if (!lv_area_intersect(&area, &t->area, &t->clip_area) || !lv_area_intersect(&area, &area, &layer->buf_area))
+        return;
+
+    int32_t width = lv_area_get_width(&area);
+    int32_t height = lv_area_get_height(&area);
+    if (!ensure_fbo(width, height))
+        return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    gl_ext.UseProgram(program);
+    if (!set_task_uniforms(t)) {
+        gl_ext.UseProgram(0);
+        return;
+    }
+    gl_ext.Uniform2f(uniforms.origin, (GLfloat)area.x1, (GLfloat)area.y1);
+
+    // Bring the current layer contents over so the shape blends onto them
+    uint32_t stride = layer->draw_buf->header.stride;
+    uint8_t *px = lv_draw_buf_goto_xy(layer->draw_buf, area.x1 - layer->buf_area.x1, area.y1 - layer->buf_area.y1);
+    glBindTexture(GL_TEXTURE_2D, fbo_texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / 4);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, px);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    if (t->type == LV_DRAW_TASK_TYPE_IMAGE)
+        glBindTexture(GL_TEXTURE_2D, image_texture);
+
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);  // leave LVGL's X byte alone
+
+    if (vao) {
+        gl_ext.BindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        gl_ext.BindVertexArray(0);
+    }
+    else {
+        gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+        gl_ext.EnableVertexAttribArray(ATTRIB_POS);
+        gl_ext.VertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (const void *)0);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glPixelStorei(GL_PACK_ROW_LENGTH, stride / 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, px);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDisable(GL_BLEND);
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    gl_ext.UseProgram(0);
+
+    stats.pixels += (uint64_t)width * height;
+}
+
+static int32_t evaluate_cb(lv_draw_unit_t *draw_unit, lv_draw_task_t *t)
+{
+    if (enabled && t->preference_score > GL_DRAW_PREFERENCE && can_draw(t)) {
+        t->preference_score = GL_DRAW_PREFERENCE;
+        t->preferred_draw_unit_id = DRAW_UNIT_ID_GL;
+    }
+    return 0;
+}
+
+static int32_t dispatch_cb(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    // The next task that is ready to draw and was given to this unit
+    lv_draw_task_t *t = NULL;
+    do {
+        t = lv_draw_get_next_available_task(layer, t, DRAW_UNIT_ID_GL);
+    } while (t && t->preferred_draw_unit_id != DRAW_UNIT_ID_GL);
+    if (!t)
+        return LV_DRAW_UNIT_IDLE;
+
+    // Layers for opacity or transformations are ARGB8888; blend into those in SW
+    if (!program || layer->color_format != LV_COLOR_FORMAT_XRGB8888 || !lv_draw_layer_alloc_buf(layer)) {
+        t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+        stats.handed_back++;
+        return LV_DRAW_UNIT_IDLE;
+    }
+
+    t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+    double start = glfwGetTime();
+    draw_task(layer, t);
+    stats.ms += (glfwGetTime() - start) * 1000.0;
+    t->state = LV_DRAW_TASK_STATE_READY;
+
+    lv_draw_dispatch_request();
+    return 1;
+}
+
+static void lookup_uniforms(void)
+{
+    uniforms.origin = gl_ext.GetUniformLocation(program, "u_origin");
+    uniforms.shape = gl_ext.GetUniformLocation(program, "u_shape");
+    uniforms.rect = gl_ext.GetUniformLocation(program, "u_rect");
+    uniforms.radius = gl_ext.GetUniformLocation(program, "u_radius");
+    uniforms.inner_rect = gl_ext.GetUniformLocation(program, "u_inner_rect");
+    uniforms.inner_radius = gl_ext.GetUniformLocation(program, "u_inner_radius");
+    uniforms.color = gl_ext.GetUniformLocation(program, "u_color");
+    uniforms.grad = gl_ext.GetUniformLocation(program, "u_grad");
+    uniforms.stop_count = gl_ext.GetUniformLocation(program, "u_stop_count");
+    uniforms.stop_color = gl_ext.GetUniformLocation(program, "u_stop_color");
+    uniforms.stop_pos = gl_ext.GetUniformLocation(program, "u_stop_pos");
+    uniforms.radial = gl_ext.GetUniformLocation(program, "u_radial");
+    uniforms.extend = gl_ext.GetUniformLocation(program, "u_extend");
+    uniforms.image = gl_ext.GetUniformLocation(program, "u_image");
+    uniforms.image_size = gl_ext.GetUniformLocation(program, "u_image_size");
+    uniforms.image_alpha = gl_ext.GetUniformLocation(program, "u_image_alpha");
+}
+
+static GLuint create_texture(void)
+{
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+bool gl_draw_init(void)
+{
+    if (!gl_ext.shaders || !gl_ext.fbo || (gl_ext.core_profile && !gl_ext.vao))
+        return false;
+
+    static const char * const attribs[] = { "a_pos" };  // ATTRIB_POS
+    program = gl_shader_build(vertex_src, fragment_src, attribs, 1);
+    if (!program)
+        return false;
+    lookup_uniforms();
+    gl_ext.UseProgram(program);
+    gl_ext.Uniform1i(uniforms.image, 0);
+    gl_ext.UseProgram(0);
+
+    gl_ext.GenBuffers(1, &vbo);
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_ext.BufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    if (gl_ext.vao) {
+        gl_ext.GenVertexArrays(1, &vao);
+        gl_ext.BindVertexArray(vao);
+        gl_ext.EnableVertexAttribArray(ATTRIB_POS);
+        gl_ext.VertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (const void *)0);
+        gl_ext.BindVertexArray(0);
+    }
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    fbo_texture = create_texture();
+    image_texture = create_texture();
+    gl_ext.GenFramebuffers(1, &fbo);
+    fbo_width = fbo_height = 0;
+
+    // LVGL owns draw units once created, so the unit is made once and reused
+    if (!unit) {
+        unit = lv_draw_create_unit(sizeof(lv_draw_unit_t));
+        unit->evaluate_cb = evaluate_cb;
+        unit->dispatch_cb = dispatch_cb;
+    }
+    enabled = true;
+    return true;
+}
+
+void gl_draw_deinit(void)
+{
+    enabled = false;
+    if (!program)
+        return;
+
+    if (vao)
+        gl_ext.DeleteVertexArrays(1, &vao);
+    gl_ext.DeleteBuffers(1, &vbo);
+    gl_ext.DeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &fbo_texture);
+    glDeleteTextures(1, &image_texture);
+    gl_ext.DeleteProgram(program);
+    vao = vbo = fbo = fbo_texture = image_texture = program = 0;
+}
+
+void gl_draw_set_enabled(bool enable)
+{
+    enabled = enable && program;
+}
+
+bool gl_draw_is_enabled(void)
+{
+    return enabled;
+}
+
+void gl_draw_get_stats(gl_draw_stats_t *out, bool reset)
+{
+    *out = stats;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,38 @@
+#ifndef GL_DRAW_H
+#define GL_DRAW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl_ext.h"
+
+// An LVGL draw unit that rasterizes fills (solid, horizontal/vertical and
+// radial gradients, rounded corners), full borders and plain ARGB8888/XRGB8888
+// images with a shader. Everything else (labels, shadows, masks, transformed
+// images, ...) stays with the SW unit.
+//
+// LVGL keeps the layers in CPU memory and runs the units one task at a time, so
+// for each claimed task the affected part of the layer is copied into an FBO,
+// the shape is blended on top and the result is read back. That keeps the
+// ordering with SW-drawn tasks exact at the cost of a round trip per task.
+
+typedef struct {
+    uint32_t fills;
+    uint32_t borders;
+    uint32_t images;
+    uint32_t handed_back;   // claimed but left to the SW unit (e.g. ARGB8888 layers)
+    uint64_t pixels;        // pixels read back into the layers
+    double ms;              // time spent drawing, including the transfers
+} gl_draw_stats_t;
+
+// Needs shaders and framebuffer objects; call after lv_init(). Returns false if
+// the context lacks them, in which case LVGL keeps drawing everything in SW.
+bool gl_draw_init(void);
+void gl_draw_deinit(void);
+
+// A disabled unit claims no new tasks, so rendering falls back to SW entirely.
+void gl_draw_set_enabled(bool enabled);
+bool gl_draw_is_enabled(void);
+
+void gl_draw_get_stats(gl_draw_stats_t *stats, bool reset);
+
+#endif // GL_DRAW_H
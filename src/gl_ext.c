@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include "gl_ext.h"
+
+gl_ext_t gl_ext;
+
+static bool version_at_least(int major, int minor)
+{
+    return gl_ext.major > major || (gl_ext.major == major && gl_ext.minor >= minor);
+}
+
+void gl_ext_load(void)
+{
+    const char *version = (const char *)glGetString(GL_VERSION);
+    if (!version || sscanf(version, "%d.%d", &gl_ext.major, &gl_ext.minor) != 2) {
+        gl_ext.major = 1;
+        gl_ext.minor = 1;
+    }
+
+#define GL_EXT_LOAD(ret, name, args) gl_ext.name = (gl_ext_##name##_fn)glfwGetProcAddress("gl" #name);
+    GL_EXT_FUNCS(GL_EXT_LOAD)
+#undef GL_EXT_LOAD
+
+    gl_ext.pbo = (version_at_least(2, 1) || glfwExtensionSupported("GL_ARB_pixel_buffer_object")) &&
+                 gl_ext.GenBuffers && gl_ext.DeleteBuffers && gl_ext.BindBuffer && gl_ext.BufferData;
+    gl_ext.map_range = (version_at_least(3, 0) || glfwExtensionSupported("GL_ARB_map_buffer_range")) &&
+                       gl_ext.MapBufferRange && gl_ext.UnmapBuffer;
+    gl_ext.sync = (version_at_least(3, 2) || glfwExtensionSupported("GL_ARB_sync")) &&
+                  gl_ext.FenceSync && gl_ext.ClientWaitSync && gl_ext.DeleteSync;
+    gl_ext.buffer_storage = (version_at_least(4, 4) || glfwExtensionSupported("GL_ARB_buffer_storage")) &&
+                            gl_ext.BufferStorage && gl_ext.FlushMappedBufferRange;
+    gl_ext.shaders = version_at_least(2, 0) && gl_ext.CreateShader && gl_ext.ShaderSource &&
+                     gl_ext.CompileShader && gl_ext.GetShaderiv && gl_ext.GetShaderInfoLog &&
+                     gl_ext.DeleteShader && gl_ext.CreateProgram && gl_ext.AttachShader &&
+                     gl_ext.BindAttribLocation && gl_ext.LinkProgram && gl_ext.GetProgramiv &&
+                     gl_ext.GetProgramInfoLog && gl_ext.DeleteProgram && gl_ext.UseProgram &&
+                     gl_ext.GetUniformLocation && gl_ext.Uniform1i && gl_ext.Uniform1f &&
+                     gl_ext.Uniform2f && gl_ext.Uniform3f && gl_ext.Uniform4f && gl_ext.Uniform1fv &&
+                     gl_ext.Uniform4fv && gl_ext.EnableVertexAttribArray && gl_ext.VertexAttribPointer &&
+                     gl_ext.ActiveTexture && gl_ext.GenBuffers && gl_ext.BindBuffer && gl_ext.BufferData;
+    gl_ext.vao = (version_at_least(3, 0) || glfwExtensionSupported("GL_ARB_vertex_array_object")) &&
+                 gl_ext.GenVertexArrays && gl_ext.BindVertexArray && gl_ext.DeleteVertexArrays;
+    gl_ext.fbo = (version_at_least(3, 0) || glfwExtensionSupported("GL_ARB_framebuffer_object")) &&
+                 gl_ext.GenFramebuffers && gl_ext.DeleteFramebuffers && gl_ext.BindFramebuffer &&
+                 gl_ext.FramebufferTexture2D && gl_ext.CheckFramebufferStatus;
+    gl_ext.timer_query = (version_at_least(3, 3) || glfwExtensionSupported("GL_ARB_timer_query")) &&
+                         gl_ext.GenQueries && gl_ext.DeleteQueries && gl_ext.QueryCounter &&
+                         gl_ext.GetQueryObjectiv && gl_ext.GetQueryObjectui64v && gl_ext.GetInteger64v;
+
+    // A 3.2+ context created with GLFW_OPENGL_CORE_PROFILE reports it in the profile mask
+    GLint profile_mask = 0;
+    if (version_at_least(3, 2)) {
+        glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile_mask);
+        glGetError();
+    }
+    gl_ext.core_profile = (profile_mask & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+}
@@ -0,0 +1,209 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#ifndef GL_SILENCE_DEPRECATION
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <GLFW/glfw3.h>
+
+// GLFW only guarantees the GL 1.1 entry points, so everything newer is resolved
+// at runtime through glfwGetProcAddress. Features are probed once per context
+// and callers pick a code path from the flags in gl_ext.
+
+#if defined(_WIN32)
+#define GL_EXT_APIENTRY __stdcall
+#else
+#define GL_EXT_APIENTRY
+#endif
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_MAP_FLUSH_EXPLICIT_BIT
+#define GL_MAP_FLUSH_EXPLICIT_BIT 0x0010
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_CONTEXT_PROFILE_MASK
+#define GL_CONTEXT_PROFILE_MASK 0x9126
+#endif
+#ifndef GL_CONTEXT_CORE_PROFILE_BIT
+#define GL_CONTEXT_CORE_PROFILE_BIT 0x00000001
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+typedef ptrdiff_t gl_ext_intptr;
+typedef ptrdiff_t gl_ext_sizeiptr;
+typedef char gl_ext_char;
+typedef struct __GLsync * gl_ext_sync;
+
+// X(return type, name without the "gl" prefix, parameter list)
+#define GL_EXT_FUNCS(X) \
+    X(void, GenBuffers, (GLsizei n, GLuint * buffers)) \
+    X(void, DeleteBuffers, (GLsizei n, const GLuint * buffers)) \
+    X(void, BindBuffer, (GLenum target, GLuint buffer)) \
+    X(void, BufferData, (GLenum target, gl_ext_sizeiptr size, const void * data, GLenum usage)) \
+    X(void *, MapBufferRange, (GLenum target, gl_ext_intptr offset, gl_ext_sizeiptr length, GLbitfield access)) \
+    X(GLboolean, UnmapBuffer, (GLenum target)) \
+    X(void, FlushMappedBufferRange, (GLenum target, gl_ext_intptr offset, gl_ext_sizeiptr length)) \
+    X(void, BufferStorage, (GLenum target, gl_ext_sizeiptr size, const void * data, GLbitfield flags)) \
+    X(gl_ext_sync, FenceSync, (GLenum condition, GLbitfield flags)) \
+    X(GLenum, ClientWaitSync, (gl_ext_sync sync, GLbitfield flags, uint64_t timeout)) \
+    X(void, DeleteSync, (gl_ext_sync sync)) \
+    X(void, ActiveTexture, (GLenum texture)) \
+    X(GLuint, CreateShader, (GLenum type)) \
+    X(void, ShaderSource, (GLuint shader, GLsizei count, const gl_ext_char * const * string, const GLint * length)) \
+    X(void, CompileShader, (GLuint shader)) \
+    X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint * params)) \
+    X(void, GetShaderInfoLog, (GLuint shader, GLsizei max_length, GLsizei * length, gl_ext_char * log)) \
+    X(void, DeleteShader, (GLuint shader)) \
+    X(GLuint, CreateProgram, (void)) \
+    X(void, AttachShader, (GLuint program, GLuint shader)) \
+    X(void, BindAttribLocation, (GLuint program, GLuint index, const gl_ext_char * name)) \
+    X(void, LinkProgram, (GLuint program)) \
+    X(void, GetProgramiv, (GLuint program, GLenum pname, GLint * params)) \
+    X(void, GetProgramInfoLog, (GLuint program, GLsizei max_length, GLsizei * length, gl_ext_char * log)) \
+    X(void, DeleteProgram, (GLuint program)) \
+    X(void, UseProgram, (GLuint program)) \
+    X(GLint, GetUniformLocation, (GLuint program, const gl_ext_char * name)) \
+    X(void, Uniform1i, (GLint location, GLint v0)) \
+    X(void, Uniform1f, (GLint location, GLfloat v0)) \
+    X(void, Uniform2f, (GLint location, GLfloat v0, GLfloat v1)) \
+    X(void, Uniform3f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)) \
+    X(void, Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)) \
+    X(void, Uniform1fv, (GLint location, GLsizei count, const GLfloat * value)) \
+    X(void, Uniform4fv, (GLint location, GLsizei count, const GLfloat * value)) \
+    X(void, EnableVertexAttribArray, (GLuint index)) \
+    X(void, DisableVertexAttribArray, (GLuint index)) \
+    X(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer)) \
+    X(void, GenVertexArrays, (GLsizei n, GLuint * arrays)) \
+    X(void, BindVertexArray, (GLuint array)) \
+    X(void, DeleteVertexArrays, (GLsizei n, const GLuint * arrays)) \
+    X(void, GenFramebuffers, (GLsizei n, GLuint * framebuffers)) \
+    X(void, DeleteFramebuffers, (GLsizei n, const GLuint * framebuffers)) \
+    X(void, BindFramebuffer, (GLenum target, GLuint framebuffer)) \
+    X(void, FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)) \
+    X(GLenum, CheckFramebufferStatus, (GLenum target)) \
+    X(void, GenQueries, (GLsizei n, GLuint * ids)) \
+    X(void, DeleteQueries, (GLsizei n, const GLuint * ids)) \
+    X(void, QueryCounter, (GLuint id, GLenum target)) \
+    X(void, GetQueryObjectiv, (GLuint id, GLenum pname, GLint * params)) \
+    X(void, GetQueryObjectui64v, (GLuint id, GLenum pname, uint64_t * params)) \
+    X(void, GetInteger64v, (GLenum pname, int64_t * data))
+
+#define GL_EXT_TYPEDEF(ret, name, args) typedef ret (GL_EXT_APIENTRY * gl_ext_##name##_fn) args;
+GL_EXT_FUNCS(GL_EXT_TYPEDEF)
+#undef GL_EXT_TYPEDEF
+
+typedef struct {
+    int major;
+    int minor;
+
+    bool pbo;               // GL 2.1 or ARB_pixel_buffer_object
+    bool map_range;         // GL 3.0 or ARB_map_buffer_range
+    bool sync;              // GL 3.2 or ARB_sync
+    bool buffer_storage;    // GL 4.4 or ARB_buffer_storage
+    bool shaders;           // GL 2.0 (GLSL programs, vertex attributes)
+    bool vao;               // GL 3.0 or ARB_vertex_array_object
+    bool fbo;               // GL 3.0 or ARB_framebuffer_object
+    bool timer_query;       // GL 3.3 or ARB_timer_query
+    bool core_profile;      // no fixed-function pipeline: glBegin/glEnd are gone
+
+#define GL_EXT_FIELD(ret, name, args) gl_ext_##name##_fn name;
+    GL_EXT_FUNCS(GL_EXT_FIELD)
+#undef GL_EXT_FIELD
+} gl_ext_t;
+
+extern gl_ext_t gl_ext;
+
+// Resolve entry points for the current context and fill in the feature flags.
+void gl_ext_load(void);
+
+#endif // GL_EXT_H
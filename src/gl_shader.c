@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include "gl_shader.h"
+
+static const char *vertex_prefix_330 =
+    "#version 330 core\n"
+    "#define ATTRIBUTE in\n"
+    "#define VARYING_OUT out\n";
+
+static const char *fragment_prefix_330 =
+    "#version 330 core\n"
+    "#define VARYING_IN in\n"
+    "#define TEXTURE texture\n"
+    "#define FRAG_COLOR frag_color\n"
+    "out vec4 frag_color;\n";
+
+static const char *vertex_prefix_120 =
+    "#version 120\n"
+    "#define ATTRIBUTE attribute\n"
+    "#define VARYING_OUT varying\n";
+
+static const char *fragment_prefix_120 =
+    "#version 120\n"
+    "#define VARYING_IN varying\n"
+    "#define TEXTURE texture2D\n"
+    "#define FRAG_COLOR gl_FragColor\n";
+
+static GLuint compile_shader(GLenum type, const char *prefix, const char *src)
+{
+    const gl_ext_char *sources[] = { prefix, src };
+    GLuint shader = gl_ext.CreateShader(type);
+    gl_ext.ShaderSource(shader, 2, sources, NULL);
+    gl_ext.CompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    gl_ext.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        gl_ext.GetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Shader compile error: %s\n", log);
+        gl_ext.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint gl_shader_build(const char *vertex_src, const char *fragment_src,
+                       const char * const *attribs, int attrib_count)
+{
+    bool glsl_330 = gl_ext.major > 3 || (gl_ext.major == 3 && gl_ext.minor >= 3);
+    GLuint vs = compile_shader(GL_VERTEX_SHADER, glsl_330 ? vertex_prefix_330 : vertex_prefix_120, vertex_src);
+    GLuint fs = compile_shader(GL_FRAGMENT_SHADER, glsl_330 ? fragment_prefix_330 : fragment_prefix_120,
+                               fragment_src);
+    if (!vs || !fs) {
+        if (vs)
+            gl_ext.DeleteShader(vs);
+        if (fs)
+            gl_ext.DeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = gl_ext.CreateProgram();
+    gl_ext.AttachShader(program, vs);
+    gl_ext.AttachShader(program, fs);
+    for (int i = 0; i < attrib_count; i++)
+        gl_ext.BindAttribLocation(program, (GLuint)i, attribs[i]);
+    gl_ext.LinkProgram(program);
+    gl_ext.DeleteShader(vs);
+    gl_ext.DeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    gl_ext.GetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        gl_ext.GetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Shader link error: %s\n", log);
+        gl_ext.DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
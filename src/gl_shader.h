@@ -0,0 +1,15 @@
+#ifndef GL_SHADER_H
+#define GL_SHADER_H
+
+#include "gl_ext.h"
+
+// Shader sources are written once against a few macros and compiled as GLSL 330
+// core on 3.3+ contexts or GLSL 120 otherwise:
+//   ATTRIBUTE, VARYING_OUT (vertex) and VARYING_IN, TEXTURE, FRAG_COLOR (fragment).
+//
+// Builds and links a program, binding attribs[i] to attribute location i.
+// Returns 0 and logs the compiler output on failure.
+GLuint gl_shader_build(const char *vertex_src, const char *fragment_src,
+                       const char * const *attribs, int attrib_count);
+
+#endif // GL_SHADER_H
@@ -0,0 +1,104 @@
+#include "gl_ext.h"
+#include "gl_trace.h"
+#include "trace_profiler.h"
+
+#define CALIBRATE_NS 1000000000u  // the GPU clock drifts against the CPU's; realign this often
+
+typedef struct {
+    GLuint queries[2];      // timestamps at the begin and the end
+    const char *name;
+    bool pending;           // ended, result not read yet
+} span_t;
+
+static bool enabled;
+static uint32_t track;
+static span_t spans[GL_TRACE_SPANS];
+static int next_span;
+static span_t *open_span;
+static int64_t gpu_offset;  // [ns] trace clock minus GPU clock
+static uint64_t calibrated;
+
+static void calibrate(void)
+{
+    int64_t gpu_now = 0;
+    gl_ext.GetInteger64v(GL_TIMESTAMP, &gpu_now);
+    calibrated = trace_profiler_now_ns();
+    gpu_offset = (int64_t)calibrated - gpu_now;
+}
+
+bool gl_trace_init(void)
+{
+    if (!gl_ext.timer_query)
+        return false;
+
+    for (int i = 0; i < GL_TRACE_SPANS; i++) {
+        gl_ext.GenQueries(2, spans[i].queries);
+        spans[i].pending = false;
+    }
+    next_span = 0;
+    open_span = NULL;
+    track = trace_profiler_add_track("GPU");
+    calibrate();
+    enabled = true;
+    return true;
+}
+
+void gl_trace_deinit(void)
+{
+    if (!enabled)
+        return;
+    for (int i = 0; i < GL_TRACE_SPANS; i++)
+        gl_ext.DeleteQueries(2, spans[i].queries);
+    enabled = false;
+}
+
+void gl_trace_begin(const char *name)
+{
+    if (!enabled || !TRACE_PROFILER_IS_ACTIVE() || open_span)
+        return;
+
+    span_t *span = &spans[next_span];
+    if (span->pending)
+        return;  // the GPU is more than GL_TRACE_SPANS spans behind
+    next_span = (next_span + 1) % GL_TRACE_SPANS;
+
+    span->name = name;
+    gl_ext.QueryCounter(span->queries[0], GL_TIMESTAMP);
+    open_span = span;
+}
+
+void gl_trace_end(void)
+{
+    if (!open_span)
+        return;
+    gl_ext.QueryCounter(open_span->queries[1], GL_TIMESTAMP);
+    open_span->pending = true;
+    open_span = NULL;
+}
+
+void gl_trace_collect(void)
+{
+    if (!enabled)
+        return;
+
+    // Spans finish in the order they were issued: stop at the first one still in flight
+    for (int i = 0; i < GL_TRACE_SPANS; i++) {
+        span_t *span = &spans[(next_span + i) % GL_TRACE_SPANS];
+        if (!span->pending)
+            continue;
+
+        GLint available = 0;
+        gl_ext.GetQueryObjectiv(span->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        uint64_t begin = 0, end = 0;
+        gl_ext.GetQueryObjectui64v(span->queries[0], GL_QUERY_RESULT, &begin);
+        gl_ext.GetQueryObjectui64v(span->queries[1], GL_QUERY_RESULT, &end);
+        span->pending = false;
+        trace_profiler_complete(track, span->name, (uint64_t)((int64_t)begin + gpu_offset), end - begin);
+    }
+
+    if (trace_profiler_now_ns() - calibrated > CALIBRATE_NS)
+        calibrate();
+}
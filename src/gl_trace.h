@@ -0,0 +1,39 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <stdbool.h>
+#include "lvgl.h"
+
+// GPU spans for the trace profiler (trace_profiler.h): a pair of GL timestamp
+// queries around a stretch of GL commands measures when the GPU got to them,
+// shown on a "GPU" track of its own. Results are collected without waiting,
+// a frame or more later. Needs ARB_timer_query (GL 3.3).
+
+#define GL_TRACE_SPANS 64   // spans in flight; one begun with none free is not traced
+
+#if LV_USE_PROFILER
+
+// Context thread, after gl_ext_load and trace_profiler_start. Returns false if
+// timer queries are missing.
+bool gl_trace_init(void);
+void gl_trace_deinit(void);
+
+// `name` must stay valid until the trace is dumped. Spans do not nest.
+void gl_trace_begin(const char *name);
+void gl_trace_end(void);
+
+// Once per frame, e.g. after the swap: hand finished spans to the profiler.
+void gl_trace_collect(void);
+
+#else
+
+// Built without LVGL_GLFW_TRACE
+static inline bool gl_trace_init(void) { return false; }
+static inline void gl_trace_deinit(void) {}
+static inline void gl_trace_begin(const char *name) { (void)name; }
+static inline void gl_trace_end(void) {}
+static inline void gl_trace_collect(void) {}
+
+#endif
+
+#endif // GL_TRACE_H
@@ -0,0 +1,459 @@
+#include <string.h>
+#include "gl_upload.h"
+#include "dirty_rects.h"
+#include "buffer_pool.h"
+#include "gl_trace.h"
+
+#define PBO_RING_SIZE 3
+
+typedef struct {
+    GLuint pbo;
+    size_t capacity;
+    gl_ext_sync fence;
+    double submit_time;
+} pbo_slot_t;
+
+static GLuint texture;
+static GLenum format;
+static gl_upload_mode_t mode;
+static pbo_slot_t ring[PBO_RING_SIZE];
+static int ring_next;
+
+// Persistent modes: the whole LVGL frame lives in one mapped buffer
+static struct {
+    GLuint buffer;
+    uint8_t *map;
+    size_t size;
+    gl_ext_sync fence;
+    double submit_time;
+} frame;
+
+// Areas flushed during the current refresh. Uploads are deferred to the last
+// flush so they can be merged, and so the GPU never reads a region of a mapped
+// frame that LVGL is about to render into again.
+static struct {
+    dirty_rects_t rects;
+    uint32_t received;      // can exceed rects.count once the list overflows
+    const uint8_t *px_map;
+    int32_t stride;
+    int32_t x0;             // screen position of px_map's first pixel
+    int32_t y0;
+    bool coalesce;
+    uint32_t overhead_px;
+} batch = {
+    .coalesce = true,
+    .overhead_px = DIRTY_RECTS_DEFAULT_OVERHEAD_PX,
+};
+
+// The current refresh so far; it may take several batches (one per band in
+// partial render mode)
+static struct {
+    uint32_t areas;
+    uint32_t uploads;
+    double cpu_ms;
+} frame_stats;
+
+static gl_upload_stats_t stats;
+
+static double now_ms(void)
+{
+    return glfwGetTime() * 1000.0;
+}
+
+static void retire_fence(gl_ext_sync *fence, double submit_time, double now)
+{
+    stats.gpu_samples++;
+    stats.gpu_ms += now - submit_time;
+    gl_ext.DeleteSync(*fence);
+    *fence = NULL;
+}
+
+static void wait_fence(gl_ext_sync *fence, double submit_time)
+{
+    if (!*fence)
+        return;
+
+    double start = now_ms();
+    GLenum status = gl_ext.ClientWaitSync(*fence, 0, 0);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        retire_fence(fence, submit_time, start);
+        return;
+    }
+
+    do {
+        status = gl_ext.ClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1 ms
+    } while (status == GL_TIMEOUT_EXPIRED);
+
+    double now = now_ms();
+    stats.stalls++;
+    stats.stall_ms += now - start;
+    retire_fence(fence, submit_time, now);
+}
+
+// Retire every transfer the GPU has already finished, without blocking.
+static void poll_fences(void)
+{
+    for (int i = 0; i < PBO_RING_SIZE; i++) {
+        if (!ring[i].fence)
+            continue;
+        GLenum status = gl_ext.ClientWaitSync(ring[i].fence, 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+            retire_fence(&ring[i].fence, ring[i].submit_time, now_ms());
+    }
+}
+
+static size_t area_bytes(const lv_area_t *area)
+{
+    return (size_t)lv_area_get_width(area) * lv_area_get_height(area) * sizeof(lv_color32_t);
+}
+
+static bool is_persistent(gl_upload_mode_t m)
+{
+    return m == GL_UPLOAD_PERSISTENT || m == GL_UPLOAD_PERSISTENT_FLUSH;
+}
+
+static const uint8_t *area_source(const lv_area_t *area)
+{
+    return batch.px_map + (area->y1 - batch.y0) * batch.stride + (area->x1 - batch.x0) * sizeof(lv_color32_t);
+}
+
+static void submit_direct(const dirty_rects_t *rects, int32_t stride)
+{
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / sizeof(lv_color32_t));  // Rows are spaced by the full buffer width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Ensure 1-byte alignment
+
+    for (int i = 0; i < rects->count; i++) {
+        const lv_area_t *area = &rects->areas[i];
+        const uint8_t *start_pos = area_source(area);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, area->x1, area->y1,
+                        lv_area_get_width(area), lv_area_get_height(area),
+                        format, GL_UNSIGNED_BYTE, start_pos);
+    }
+
+    // Reset the row length
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+static void submit_pbo(const dirty_rects_t *rects, int32_t stride)
+{
+    size_t size = 0;
+    for (int i = 0; i < rects->count; i++)
+        size += area_bytes(&rects->areas[i]);
+
+    poll_fences();
+
+    // The whole batch is packed into one slot, guarded by one fence
+    pbo_slot_t *slot = &ring[ring_next];
+    ring_next = (ring_next + 1) % PBO_RING_SIZE;
+    wait_fence(&slot->fence, slot->submit_time);
+
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->pbo);
+    if (size > slot->capacity) {
+        gl_ext.BufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        slot->capacity = size;
+    }
+
+    // The slot's fence has retired, so nothing on the GPU still reads it
+    uint8_t *dst = gl_ext.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT |
+                                         GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!dst) {
+        gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        submit_direct(rects, stride);
+        return;
+    }
+
+    for (int i = 0; i < rects->count; i++) {
+        const lv_area_t *area = &rects->areas[i];
+        size_t row_bytes = (size_t)lv_area_get_width(area) * sizeof(lv_color32_t);
+        const uint8_t *src = area_source(area);
+        for (int32_t y = area->y1; y <= area->y2; y++) {
+            memcpy(dst, src, row_bytes);
+            dst += row_bytes;
+            src += stride;
+        }
+    }
+    gl_ext.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // With a PBO bound the last argument is an offset and the call returns without waiting for the copy
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    size_t offset = 0;
+    for (int i = 0; i < rects->count; i++) {
+        const lv_area_t *area = &rects->areas[i];
+        glTexSubImage2D(GL_TEXTURE_2D, 0, area->x1, area->y1,
+                        lv_area_get_width(area), lv_area_get_height(area),
+                        format, GL_UNSIGNED_BYTE, (const void *)offset);
+        offset += area_bytes(area);
+    }
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    slot->fence = gl_ext.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->submit_time = now_ms();
+}
+
+static void submit_persistent(const dirty_rects_t *rects, int32_t stride)
+{
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, frame.buffer);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / sizeof(lv_color32_t));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int i = 0; i < rects->count; i++) {
+        const lv_area_t *area = &rects->areas[i];
+        int32_t w = lv_area_get_width(area);
+        int32_t h = lv_area_get_height(area);
+        size_t offset = (size_t)area->y1 * stride + area->x1 * sizeof(lv_color32_t);
+
+        if (mode == GL_UPLOAD_PERSISTENT_FLUSH) {
+            size_t length = (size_t)(h - 1) * stride + w * sizeof(lv_color32_t);
+            gl_ext.FlushMappedBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, length);
+        }
+
+        // The offset into the bound buffer takes the place of the pixel pointer
+        glTexSubImage2D(GL_TEXTURE_2D, 0, area->x1, area->y1, w, h,
+                        format, GL_UNSIGNED_BYTE, (const void *)offset);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // Rendering of the next frame waits on this in gl_upload_begin_frame
+    if (frame.fence)
+        gl_ext.DeleteSync(frame.fence);
+    frame.fence = gl_ext.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame.submit_time = now_ms();
+}
+
+static void submit_batch(void)
+{
+    if (batch.rects.count == 0)
+        return;
+
+    double start = now_ms();
+    uint32_t received = batch.received;
+
+    if (batch.coalesce)
+        dirty_rects_coalesce(&batch.rects, batch.overhead_px);
+
+    LV_PROFILER_BEGIN_TAG("glTexSubImage2D");
+    gl_trace_begin("glTexSubImage2D");
+    if (is_persistent(mode) && batch.px_map == frame.map)
+        submit_persistent(&batch.rects, batch.stride);
+    else if (mode == GL_UPLOAD_PBO)
+        submit_pbo(&batch.rects, batch.stride);
+    else
+        submit_direct(&batch.rects, batch.stride);  // Also covers a buffer that is not the mapped frame
+    gl_trace_end();
+    LV_PROFILER_END_TAG("glTexSubImage2D");
+
+    uint32_t issued = batch.rects.count;
+    for (int i = 0; i < batch.rects.count; i++)
+        stats.bytes += area_bytes(&batch.rects.areas[i]);
+    dirty_rects_reset(&batch.rects);
+    batch.received = 0;
+
+    frame_stats.areas += received;
+    frame_stats.uploads += issued;
+    frame_stats.cpu_ms += now_ms() - start;
+}
+
+static void end_frame_stats(void)
+{
+    if (frame_stats.areas == 0)
+        return;
+
+    stats.frames++;
+    stats.areas += frame_stats.areas;
+    stats.uploads += frame_stats.uploads;
+    if (frame_stats.areas > stats.areas_max)
+        stats.areas_max = frame_stats.areas;
+    if (frame_stats.uploads > stats.uploads_max)
+        stats.uploads_max = frame_stats.uploads;
+    stats.cpu_ms += frame_stats.cpu_ms;
+    if (frame_stats.cpu_ms > stats.cpu_ms_max)
+        stats.cpu_ms_max = frame_stats.cpu_ms;
+    memset(&frame_stats, 0, sizeof(frame_stats));
+}
+
+static void release_frame(void)
+{
+    if (!frame.buffer)
+        return;
+
+    wait_fence(&frame.fence, frame.submit_time);
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, frame.buffer);
+    gl_ext.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    gl_ext.DeleteBuffers(1, &frame.buffer);
+    memset(&frame, 0, sizeof(frame));
+}
+
+void gl_upload_init(GLuint tex, GLenum pixel_format, gl_upload_mode_t preferred)
+{
+    texture = tex;
+    format = pixel_format;
+    mode = GL_UPLOAD_DIRECT;
+    memset(&stats, 0, sizeof(stats));
+    memset(&frame_stats, 0, sizeof(frame_stats));
+    dirty_rects_reset(&batch.rects);
+
+    if (preferred == GL_UPLOAD_DIRECT || !gl_ext.pbo || !gl_ext.map_range || !gl_ext.sync)
+        return;
+
+    if (is_persistent(preferred) && gl_ext.buffer_storage) {
+        mode = preferred;
+        return;
+    }
+
+    GLuint pbos[PBO_RING_SIZE];
+    gl_ext.GenBuffers(PBO_RING_SIZE, pbos);
+    for (int i = 0; i < PBO_RING_SIZE; i++) {
+        ring[i].pbo = pbos[i];
+        ring[i].capacity = 0;
+        ring[i].fence = NULL;
+    }
+    ring_next = 0;
+    mode = GL_UPLOAD_PBO;
+}
+
+void gl_upload_deinit(void)
+{
+    dirty_rects_reset(&batch.rects);
+    if (is_persistent(mode))
+        release_frame();
+    if (mode != GL_UPLOAD_PBO) {
+        mode = GL_UPLOAD_DIRECT;
+        return;
+    }
+
+    for (int i = 0; i < PBO_RING_SIZE; i++) {
+        if (ring[i].fence)
+            gl_ext.DeleteSync(ring[i].fence);
+        gl_ext.DeleteBuffers(1, &ring[i].pbo);
+        memset(&ring[i], 0, sizeof(ring[i]));
+    }
+    mode = GL_UPLOAD_DIRECT;
+}
+
+gl_upload_mode_t gl_upload_get_mode(void)
+{
+    return mode;
+}
+
+const char *gl_upload_mode_name(gl_upload_mode_t m)
+{
+    switch (m) {
+        case GL_UPLOAD_PERSISTENT: return "persistent";
+        case GL_UPLOAD_PERSISTENT_FLUSH: return "persistent-flush";
+        case GL_UPLOAD_PBO: return "pbo";
+        case GL_UPLOAD_DIRECT: return "direct";
+    }
+    return "?";
+}
+
+bool gl_upload_parse_mode(const char *name, gl_upload_mode_t *out)
+{
+    static const gl_upload_mode_t modes[] = {
+        GL_UPLOAD_DIRECT, GL_UPLOAD_PBO, GL_UPLOAD_PERSISTENT, GL_UPLOAD_PERSISTENT_FLUSH,
+    };
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(name, gl_upload_mode_name(modes[i])) == 0) {
+            *out = modes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void gl_upload_set_coalesce(bool enable, uint32_t overhead_px)
+{
+    batch.coalesce = enable;
+    batch.overhead_px = overhead_px;
+}
+
+uint8_t *gl_upload_map_frame(int32_t width, int32_t height)
+{
+    if (!is_persistent(mode))
+        return NULL;
+
+    // Rows are `width` apart whatever the capacity, so any mapping that is large
+    // enough (and not wastefully so) can be kept across a resize
+    size_t size = (size_t)width * height * sizeof(lv_color32_t);
+    if (frame.map && size <= frame.size && size * 2 >= frame.size)
+        return frame.map;
+    size = buffer_pool_size_class(size);
+
+    // Areas queued against the old mapping must not be read after it is gone
+    dirty_rects_reset(&batch.rects);
+    batch.received = 0;
+    release_frame();
+
+    // LVGL reads the destination back whenever it blends, so the mapping must be readable
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+    flags |= mode == GL_UPLOAD_PERSISTENT ? GL_MAP_COHERENT_BIT : 0;
+
+    gl_ext.GenBuffers(1, &frame.buffer);
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, frame.buffer);
+    gl_ext.BufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+    frame.map = gl_ext.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                      flags | (mode == GL_UPLOAD_PERSISTENT ? 0 : GL_MAP_FLUSH_EXPLICIT_BIT));
+    gl_ext.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    frame.size = size;
+
+    if (!frame.map) {
+        // Storage or mapping was refused; let the caller fall back to client memory
+        gl_ext.DeleteBuffers(1, &frame.buffer);
+        memset(&frame, 0, sizeof(frame));
+        mode = GL_UPLOAD_DIRECT;
+    }
+    return frame.map;
+}
+
+void gl_upload_begin_frame(void)
+{
+    if (is_persistent(mode))
+        wait_fence(&frame.fence, frame.submit_time);
+}
+
+void gl_upload_area(const lv_area_t *area, const uint8_t *px_map, int32_t stride)
+{
+    // Areas of different buffers cannot share a batch
+    if (batch.rects.count > 0 && (px_map != batch.px_map || stride != batch.stride || batch.x0 || batch.y0))
+        submit_batch();
+
+    batch.px_map = px_map;
+    batch.stride = stride;
+    batch.x0 = 0;
+    batch.y0 = 0;
+    batch.received++;
+    dirty_rects_add(&batch.rects, area);
+}
+
+void gl_upload_band(const lv_area_t *area, const uint8_t *px_map, int32_t stride)
+{
+    submit_batch();
+
+    batch.px_map = px_map;
+    batch.stride = stride;
+    batch.x0 = area->x1;
+    batch.y0 = area->y1;
+    batch.received = 1;
+    dirty_rects_add(&batch.rects, area);
+    submit_batch();
+}
+
+void gl_upload_frame_done(void)
+{
+    submit_batch();
+    end_frame_stats();
+}
+
+void gl_upload_get_stats(gl_upload_stats_t *out, bool reset)
+{
+    *out = stats;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,74 @@
+#ifndef GL_UPLOAD_H
+#define GL_UPLOAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl_ext.h"
+#include "lvgl.h"
+
+typedef enum {
+    GL_UPLOAD_DIRECT,           // glTexSubImage2D straight from the LVGL draw buffer
+    GL_UPLOAD_PBO,              // stage into a ring of pixel buffer objects guarded by fences
+    GL_UPLOAD_PERSISTENT,       // LVGL renders into a coherent, persistently mapped buffer
+    GL_UPLOAD_PERSISTENT_FLUSH, // same, but non-coherent with explicit flushes of the dirty rows
+} gl_upload_mode_t;
+
+typedef struct {
+    uint32_t frames;        // refreshes that flushed at least one area
+    uint32_t areas;         // areas received from LVGL
+    uint32_t areas_max;     // most areas received in one frame
+    uint32_t uploads;       // texture uploads issued after coalescing
+    uint32_t uploads_max;   // most uploads issued in one frame
+    uint64_t bytes;
+    double cpu_ms;          // time spent submitting, i.e. how long the last flush blocks LVGL
+    double cpu_ms_max;      // worst frame
+    uint32_t gpu_samples;   // PBO/persistent: transfers whose fence was seen signaled
+    double gpu_ms;          // PBO/persistent: submit until the fence was seen signaled (upper bound)
+    uint32_t stalls;        // PBO: a ring slot was still in flight when it came up for reuse,
+                            // persistent: the previous transfer was still reading the frame
+    double stall_ms;
+} gl_upload_stats_t;
+
+// Probe the current context and use `preferred` if it is supported, otherwise
+// fall back persistent -> PBO ring -> direct. `texture` must already exist;
+// `pixel_format` is the glTexSubImage2D format LVGL's pixels are passed as.
+void gl_upload_init(GLuint texture, GLenum pixel_format, gl_upload_mode_t preferred);
+void gl_upload_deinit(void);
+
+gl_upload_mode_t gl_upload_get_mode(void);
+const char *gl_upload_mode_name(gl_upload_mode_t mode);
+bool gl_upload_parse_mode(const char *name, gl_upload_mode_t *mode);
+
+// In the persistent modes, (re)create the GPU-visible frame LVGL renders into and
+// return its mapping. Returns NULL in the other modes; the caller then owns the
+// draw buffer as before. The mapping is readable, since LVGL's SW renderer reads
+// what it blends onto (anti-aliased edges, translucent fills, text), but the
+// driver may still place it in uncached or write-combined memory where each of
+// those reads is far slower than from client memory; blend-heavy scenes can
+// render slower in these modes than with the PBO ring.
+uint8_t *gl_upload_map_frame(int32_t width, int32_t height);
+
+// Call before LVGL starts rendering a frame: in the persistent modes it waits
+// until the GPU has finished reading the previous frame out of the mapping.
+void gl_upload_begin_frame(void);
+
+// Merge the areas of a refresh before uploading them (default on). `overhead_px`
+// is the cost of one extra upload in pixels, see dirty_rects_coalesce.
+void gl_upload_set_coalesce(bool enable, uint32_t overhead_px);
+
+// Queue `area` of `px_map` for upload into the texture. `px_map` points at the
+// pixel (0, 0) of a buffer with `stride` bytes per row, laid out in LVGL's
+// native XRGB8888, and must stay valid until gl_upload_frame_done.
+void gl_upload_area(const lv_area_t *area, const uint8_t *px_map, int32_t stride);
+
+// Upload `area` right away from a buffer that holds just that area, as LVGL's
+// partial render mode passes it: `px_map` points at the area's top-left pixel
+// and may be reused as soon as this returns.
+void gl_upload_band(const lv_area_t *area, const uint8_t *px_map, int32_t stride);
+
+// Call after the last area of a refresh: merges the queued areas and uploads them.
+void gl_upload_frame_done(void);
+
+void gl_upload_get_stats(gl_upload_stats_t *stats, bool reset);
+
+#endif // GL_UPLOAD_H
@@ -0,0 +1,302 @@
+#include <stdatomic.h>
+#include "glfw_input.h"
+#include "event_queue.h"
+#include "presenter.h"
+#include "latency_trace.h"
+#include "input_replay.h"
+
+static event_queue_t pointer_queue;
+static event_queue_t wheel_queue;
+static event_queue_t key_queue;
+static void (*wake_cb)(void);
+static bool event_mode;
+static bool live = true;  // main thread: false while replaying, the window's input is ignored
+static double scroll_remainder;  // main thread: touchpads scroll in fractions of a step
+
+// LVGL thread: the state as of the last event read
+static lv_indev_t *pointer_indev;
+static lv_indev_t *wheel_indev;
+static lv_indev_t *keypad_indev;
+static app_event_t pointer;
+static app_event_t key;
+
+static struct {
+    atomic_uint events;
+    atomic_uint coalesced;
+    atomic_uint reads;
+} stats;
+
+static event_queue_t *queue_for(app_event_type_t type)
+{
+    if (type == APP_EVENT_SCROLL)
+        return &wheel_queue;
+    return type == APP_EVENT_KEY ? &key_queue : &pointer_queue;
+}
+
+static void push(event_queue_t *queue, app_event_t *event)
+{
+    if (!live)
+        return;
+
+    // The same clock as LVGL's tick (tick_get_cb in main.c)
+    event->time = glfwGetTime();
+    event->timestamp = (uint32_t)(uint64_t)(event->time * 1000.0);
+    event_queue_push(queue, event);
+    atomic_fetch_add_explicit(&stats.events, 1, memory_order_relaxed);
+    if (wake_cb)
+        wake_cb();
+}
+
+static void push_pointer(GLFWwindow *window, app_event_type_t type, double x, double y, bool pressed)
+{
+    app_event_t event = { .type = type, .pressed = pressed };
+    presenter_window_to_frame(x, y, &event.x, &event.y);
+    push(&pointer_queue, &event);
+}
+
+static void cursor_pos_callback(GLFWwindow *window, double x, double y)
+{
+    push_pointer(window, APP_EVENT_POINTER, x, y, glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
+}
+
+static void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
+{
+    if (button != GLFW_MOUSE_BUTTON_LEFT)
+        return;
+
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    push_pointer(window, APP_EVENT_BUTTON, x, y, action == GLFW_PRESS);
+}
+
+static void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+{
+    if (!live)
+        return;
+
+    scroll_remainder += yoffset;
+    int32_t steps = (int32_t)scroll_remainder;
+    if (steps == 0)
+        return;
+    scroll_remainder -= steps;
+
+    app_event_t event = { .type = APP_EVENT_SCROLL, .y = steps };
+    push(&wheel_queue, &event);
+}
+
+static uint32_t lv_key_for(int glfw_key, int mods)
+{
+    switch (glfw_key) {
+    case GLFW_KEY_UP: return LV_KEY_UP;
+    case GLFW_KEY_DOWN: return LV_KEY_DOWN;
+    case GLFW_KEY_LEFT: return LV_KEY_LEFT;
+    case GLFW_KEY_RIGHT: return LV_KEY_RIGHT;
+    case GLFW_KEY_ESCAPE: return LV_KEY_ESC;
+    case GLFW_KEY_ENTER:
+    case GLFW_KEY_KP_ENTER: return LV_KEY_ENTER;
+    case GLFW_KEY_BACKSPACE: return LV_KEY_BACKSPACE;
+    case GLFW_KEY_DELETE: return LV_KEY_DEL;
+    case GLFW_KEY_HOME: return LV_KEY_HOME;
+    case GLFW_KEY_END: return LV_KEY_END;
+    case GLFW_KEY_TAB: return (mods & GLFW_MOD_SHIFT) ? LV_KEY_PREV : LV_KEY_NEXT;
+    default: return 0;  // printable keys arrive through the character callback
+    }
+}
+
+static void push_key(uint32_t lv_key, bool pressed)
+{
+    app_event_t event = { .type = APP_EVENT_KEY, .key = lv_key, .pressed = pressed };
+    push(&key_queue, &event);
+}
+
+static void key_callback(GLFWwindow *window, int glfw_key, int scancode, int action, int mods)
+{
+    uint32_t lv_key = lv_key_for(glfw_key, mods);
+    if (lv_key == 0)
+        return;
+
+    // LVGL only repeats a held key on periodic reads; deliver each repeat as a new press
+    if (action == GLFW_REPEAT)
+        push_key(lv_key, false);
+    push_key(lv_key, action != GLFW_RELEASE);
+}
+
+static void char_callback(GLFWwindow *window, unsigned int codepoint)
+{
+    push_key(codepoint, true);
+    push_key(codepoint, false);
+}
+
+// The next event to hand to LVGL. Motion followed by more motion is skipped: only
+// where the pointer ends up matters, and presses and releases are never merged.
+static bool next_pointer_event(app_event_t *event)
+{
+    if (!event_queue_pop(&pointer_queue, event))
+        return false;
+
+    app_event_t next;
+    while (event->type == APP_EVENT_POINTER && event_queue_peek(&pointer_queue, &next) &&
+           next.type == APP_EVENT_POINTER) {
+        event_queue_pop(&pointer_queue, event);
+        atomic_fetch_add_explicit(&stats.coalesced, 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+static void pointer_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    app_event_t event;
+    if (next_pointer_event(&event)) {
+        pointer = event;
+        atomic_fetch_add_explicit(&stats.reads, 1, memory_order_relaxed);
+        if (input_record_is_enabled())
+            input_record_event(&event);
+        // Hovering rarely changes anything on screen; dragging does
+        if (latency_trace_is_enabled() && (event.type != APP_EVENT_POINTER || event.pressed))
+            latency_trace_input(event.time);
+    }
+
+    data->point.x = pointer.x;
+    data->point.y = pointer.y;
+    data->state = pointer.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->timestamp = pointer.timestamp;
+    data->continue_reading = !event_queue_is_empty(&pointer_queue);
+}
+
+static void wheel_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    // Steps simply add up, so everything queued goes in one read
+    app_event_t event;
+    int32_t steps = 0;
+    double first = 0.0;
+    while (event_queue_pop(&wheel_queue, &event)) {
+        if (steps == 0)
+            first = event.time;
+        steps += event.y;
+        data->timestamp = event.timestamp;
+    }
+    if (steps) {
+        atomic_fetch_add_explicit(&stats.reads, 1, memory_order_relaxed);
+        if (latency_trace_is_enabled())
+            latency_trace_input(first);
+        if (input_record_is_enabled()) {
+            // Recorded as the one event LVGL was given
+            event.y = steps;
+            input_record_event(&event);
+        }
+    }
+
+    data->enc_diff = (int16_t)LV_CLAMP(INT16_MIN, -steps, INT16_MAX);
+    data->state = LV_INDEV_STATE_RELEASED;
+}
+
+static void keypad_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    app_event_t event;
+    if (event_queue_pop(&key_queue, &event)) {
+        key = event;
+        atomic_fetch_add_explicit(&stats.reads, 1, memory_order_relaxed);
+        if (input_record_is_enabled())
+            input_record_event(&event);
+        if (latency_trace_is_enabled())
+            latency_trace_input(event.time);
+    }
+
+    data->key = key.key;
+    data->state = key.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->timestamp = key.timestamp;
+    data->continue_reading = !event_queue_is_empty(&key_queue);
+}
+
+static lv_indev_t *create_indev(lv_indev_type_t type, lv_indev_read_cb_t read_cb, lv_group_t *group)
+{
+    lv_indev_t *indev = lv_indev_create();
+    lv_indev_set_type(indev, type);
+    lv_indev_set_read_cb(indev, read_cb);
+    if (group)
+        lv_indev_set_group(indev, group);
+    if (event_mode)
+        lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+    return indev;
+}
+
+void glfw_input_init(GLFWwindow *window, bool events, void (*wake)(void))
+{
+    event_queue_init(&pointer_queue);
+    event_queue_init(&wheel_queue);
+    event_queue_init(&key_queue);
+    wake_cb = wake;
+    event_mode = events;
+
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    presenter_window_to_frame(x, y, &pointer.x, &pointer.y);
+
+    // Buttons and other focusable widgets created from here on can be reached by keyboard and wheel
+    lv_group_t *group = lv_group_create();
+    lv_group_set_default(group);
+
+    pointer_indev = create_indev(LV_INDEV_TYPE_POINTER, pointer_read_cb, NULL);
+    wheel_indev = create_indev(LV_INDEV_TYPE_ENCODER, wheel_read_cb, group);
+    keypad_indev = create_indev(LV_INDEV_TYPE_KEYPAD, keypad_read_cb, group);
+
+    glfwSetCursorPosCallback(window, cursor_pos_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCharCallback(window, char_callback);
+}
+
+void glfw_input_process(void)
+{
+    if (!event_mode)
+        return;
+
+    if (!event_queue_is_empty(&pointer_queue) || pointer.pressed)
+        lv_indev_read(pointer_indev);
+    if (!event_queue_is_empty(&wheel_queue))
+        lv_indev_read(wheel_indev);
+    if (!event_queue_is_empty(&key_queue) || key.pressed)
+        lv_indev_read(keypad_indev);
+}
+
+void glfw_input_set_live(bool enable)
+{
+    live = enable;
+    scroll_remainder = 0.0;
+}
+
+void glfw_input_inject(const app_event_t *event)
+{
+    event_queue_push(queue_for(event->type), event);
+    atomic_fetch_add_explicit(&stats.events, 1, memory_order_relaxed);
+    if (wake_cb)
+        wake_cb();
+}
+
+bool glfw_input_is_held(void)
+{
+    return pointer.pressed || key.pressed;
+}
+
+lv_indev_t *glfw_input_get_pointer(void)
+{
+    return pointer_indev;
+}
+
+void glfw_input_get_stats(glfw_input_stats_t *out, bool reset)
+{
+    out->events = atomic_load(&stats.events);
+    out->coalesced = atomic_load(&stats.coalesced);
+    out->reads = atomic_load(&stats.reads);
+    out->dropped = atomic_load(&pointer_queue.dropped) + atomic_load(&wheel_queue.dropped) +
+                   atomic_load(&key_queue.dropped);
+    if (reset) {
+        atomic_store(&stats.events, 0);
+        atomic_store(&stats.coalesced, 0);
+        atomic_store(&stats.reads, 0);
+        atomic_store(&pointer_queue.dropped, 0);
+        atomic_store(&wheel_queue.dropped, 0);
+        atomic_store(&key_queue.dropped, 0);
+    }
+}
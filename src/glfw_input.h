@@ -0,0 +1,51 @@
+#ifndef GLFW_INPUT_H
+#define GLFW_INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <GLFW/glfw3.h>
+#include "lvgl.h"
+#include "event_queue.h"
+
+// GLFW input delivered to LVGL as events instead of sampled state. The cursor,
+// button, scroll, key and character callbacks push timestamped events into
+// SPSC rings (event_queue.h); the indev read callbacks drain them, asking LVGL
+// for another read with continue_reading while more are queued. Runs of pure
+// motion collapse into their last position, every press and release is kept,
+// and scroll steps are summed.
+//
+// Three indevs: the pointer, the wheel as an encoder and the keyboard as a
+// keypad, the latter two bound to a default group that widgets created after
+// glfw_input_init join.
+
+typedef struct {
+    uint32_t events;        // queued by the GLFW callbacks
+    uint32_t coalesced;     // motion events skipped for a later one
+    uint32_t reads;         // indev reads that consumed events
+    uint32_t dropped;       // the ring was full
+} glfw_input_stats_t;
+
+// Main thread, after lv_init(). In event mode the indevs only read when
+// glfw_input_process is called; otherwise LVGL's indev timer reads them, which
+// drains the same queues. `wake` (may be NULL) is called after every push, for
+// a consumer on another thread.
+void glfw_input_init(GLFWwindow *window, bool event_mode, void (*wake)(void));
+
+// LVGL thread, event mode: read every indev with queued events. While the
+// pointer or a key is held the indevs are read regardless, for long press and
+// repeat; glfw_input_is_held tells the loop to come back in time for that.
+void glfw_input_process(void);
+bool glfw_input_is_held(void);
+
+// Main thread: with `live` false the window's input is ignored, for replaying a
+// recording (input_replay.h) undisturbed.
+void glfw_input_set_live(bool live);
+
+// Queue an event as if GLFW had reported it, keeping its time and timestamp.
+void glfw_input_inject(const app_event_t *event);
+
+lv_indev_t *glfw_input_get_pointer(void);
+
+void glfw_input_get_stats(glfw_input_stats_t *stats, bool reset);
+
+#endif // GLFW_INPUT_H
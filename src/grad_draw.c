@@ -0,0 +1,440 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "lvgl_private.h"  // lv_draw_unit_t, lv_draw_task_t, lv_layer_t internals
+#include "grad_draw.h"
+#include "lru_cache.h"
+
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM && defined(__x86_64__) && defined(__GNUC__)
+#define GRAD_DRAW_SIMD 1
+#include <immintrin.h>
+#include "blend_x86.h"
+#else
+#define GRAD_DRAW_SIMD 0
+#endif
+
+#define DRAW_UNIT_ID_GRAD 21    // next to the GL unit's id
+#define GRAD_DRAW_PREFERENCE 70 // below the GL unit's 80: a copy beats its round trip
+#define RADIAL_STEPS 256        // radial gradients are looked up over 0..255, as in LVGL
+#define AVX2 __attribute__((target("avx2")))
+
+typedef struct {
+    int32_t dir;
+    int32_t extend;
+    int32_t width;
+    int32_t height;
+    int32_t cx;         // radial only: centre relative to the object and radius
+    int32_t cy;
+    int32_t radius;
+    int32_t stops_count;
+    uint32_t stop_color[LV_GRADIENT_MAX_STOPS];
+    uint8_t stop_frac[LV_GRADIENT_MAX_STOPS];
+} grad_key_t;
+
+typedef struct {
+    lru_slot_t slot;
+    grad_key_t key;
+    uint32_t *ramp;
+    int32_t ramp_len;
+    uint32_t *surface;  // radial only, width x height; NULL if it would not fit the budget
+} grad_entry_t;
+
+static void release_entry(void *entry)
+{
+    grad_entry_t *e = entry;
+    free(e->ramp);
+    free(e->surface);
+}
+
+static lv_draw_unit_t *unit;
+static bool enabled;
+static grad_entry_t entries[GRAD_DRAW_CACHE_ENTRIES];
+static lru_cache_t cache = LRU_CACHE_INIT(entries, grad_entry_t, key, GRAD_DRAW_CACHE_BYTES, release_entry);
+static grad_draw_stats_t stats;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+#if LV_USE_DRAW_SW_COMPLEX_GRADIENTS
+// Same restriction as the GL unit: the parameter is simply distance / radius
+static bool resolve_radial(const lv_grad_dsc_t *grad, grad_key_t *key)
+{
+    int32_t w = key->width;
+    int32_t h = key->height;
+    int32_t cx = lv_pct_to_px(grad->params.radial.end.x, w);
+    int32_t cy = lv_pct_to_px(grad->params.radial.end.y, h);
+    int32_t ex = lv_pct_to_px(grad->params.radial.end_extent.x, w);
+    int32_t ey = lv_pct_to_px(grad->params.radial.end_extent.y, h);
+
+    if (lv_pct_to_px(grad->params.radial.focal.x, w) != cx ||
+        lv_pct_to_px(grad->params.radial.focal.y, h) != cy ||
+        lv_pct_to_px(grad->params.radial.focal_extent.x, w) != cx ||
+        lv_pct_to_px(grad->params.radial.focal_extent.y, h) != cy)
+        return false;
+
+    key->cx = cx;
+    key->cy = cy;
+    key->radius = (int32_t)lv_sqrt32((uint32_t)((ex - cx) * (ex - cx) + (ey - cy) * (ey - cy)));
+    key->extend = grad->extend;
+    return key->radius > 0;
+}
+#endif
+
+// Everything the pixels depend on, zero-padded so keys compare with memcmp
+static bool make_key(grad_key_t *key, const lv_grad_dsc_t *grad, const lv_area_t *coords)
+{
+    memset(key, 0, sizeof(*key));
+    if (grad->stops_count < 2 || grad->stops_count > LV_GRADIENT_MAX_STOPS)
+        return false;
+
+    key->dir = grad->dir;
+    key->width = lv_area_get_width(coords);
+    key->height = lv_area_get_height(coords);
+    key->stops_count = grad->stops_count;
+    for (int i = 0; i < grad->stops_count; i++) {
+        if (grad->stops[i].opa < LV_OPA_MAX)
+            return false;  // translucent stops blend with what is below
+        key->stop_color[i] = lv_color_to_u32(grad->stops[i].color);
+        key->stop_frac[i] = grad->stops[i].frac;
+    }
+
+    switch (grad->dir) {
+    case LV_GRAD_DIR_VER:
+    case LV_GRAD_DIR_HOR:
+        return true;
+#if LV_USE_DRAW_SW_COMPLEX_GRADIENTS
+    case LV_GRAD_DIR_RADIAL:
+        return resolve_radial(grad, key);
+#endif
+    default:
+        return false;
+    }
+}
+
+// The corners of a rounded fill are anti-aliased by the SW unit; anything else of
+// it is a plain gradient
+static bool clear_of_corners(int32_t radius, const lv_area_t *coords, const lv_area_t *clip)
+{
+    lv_area_t area;
+    if (radius == 0 || !lv_area_intersect(&area, coords, clip))
+        return true;
+
+    int32_t r = LV_MIN(radius, LV_MIN(lv_area_get_width(coords), lv_area_get_height(coords)) / 2);
+    return (area.x1 >= coords->x1 + r && area.x2 <= coords->x2 - r) ||
+           (area.y1 >= coords->y1 + r && area.y2 <= coords->y2 - r);
+}
+
+static uint32_t mix_u32(uint32_t a, uint32_t b, uint32_t mix)
+{
+    uint32_t out = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t ca = (a >> shift) & 0xFF;
+        uint32_t cb = (b >> shift) & 0xFF;
+        out |= LV_UDIV255(ca * mix + cb * (255 - mix)) << shift;
+    }
+    return out;
+}
+
+// Stop i sits at frac * len / 256 and the colors are interpolated in between with
+// lv_gradient_color_calculate's mix and LV_UDIV255 rounding, so linear gradients
+// match SW exactly
+static void build_ramp(uint32_t *ramp, int32_t len, const grad_key_t *key)
+{
+    int i = 1;
+    for (int32_t pos = 0; pos < len; pos++) {
+        while (i < key->stops_count - 1 && pos > (key->stop_frac[i] * len) >> 8)
+            i++;
+        int32_t lo = (key->stop_frac[i - 1] * len) >> 8;
+        int32_t hi = (key->stop_frac[i] * len) >> 8;
+        uint32_t mix = pos <= lo ? 0 : pos >= hi ? 255 : (uint32_t)((pos - lo) * 255 / (hi - lo));
+        ramp[pos] = mix_u32(key->stop_color[i], key->stop_color[i - 1], mix);
+    }
+}
+
+// The radial spans. Distances are computed in single precision with the same
+// operations in every variant, so C, SSE2 and AVX2 pick the same ramp entries.
+// LVGL's SW spans use integer math instead and may pick a neighbouring entry;
+// --draw-compare reports the difference.
+
+static inline float wrap_c(float t, int32_t extend)
+{
+    if (extend == LV_GRAD_EXTEND_REPEAT)
+        return t - (float)(int32_t)t;
+    if (extend == LV_GRAD_EXTEND_REFLECT) {
+        float u = t * 0.5f;
+        u -= (float)(int32_t)u;
+        float d = u * 2.0f - 1.0f;
+        return 1.0f - (d < 0.0f ? -d : d);
+    }
+    return t < 1.0f ? t : 1.0f;
+}
+
+static void radial_span_c(uint32_t *dst, int32_t count, int32_t dx, float dy2, float inv_r, int32_t extend,
+                          const uint32_t *ramp)
+{
+    for (int32_t i = 0; i < count; i++) {
+        float x = (float)(dx + i);
+        float t = wrap_c(sqrtf(x * x + dy2) * inv_r, extend);
+        dst[i] = ramp[(int32_t)(t * 255.0f + 0.5f)];
+    }
+}
+
+#if GRAD_DRAW_SIMD
+
+static inline __m128 wrap_sse2(__m128 t, int32_t extend)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    if (extend == LV_GRAD_EXTEND_REPEAT)
+        return _mm_sub_ps(t, _mm_cvtepi32_ps(_mm_cvttps_epi32(t)));
+    if (extend == LV_GRAD_EXTEND_REFLECT) {
+        __m128 u = _mm_mul_ps(t, _mm_set1_ps(0.5f));
+        u = _mm_sub_ps(u, _mm_cvtepi32_ps(_mm_cvttps_epi32(u)));
+        __m128 d = _mm_sub_ps(_mm_mul_ps(u, _mm_set1_ps(2.0f)), one);
+        return _mm_sub_ps(one, _mm_andnot_ps(_mm_set1_ps(-0.0f), d));
+    }
+    return _mm_min_ps(t, one);
+}
+
+static void radial_span_sse2(uint32_t *dst, int32_t count, int32_t dx, float dy2, float inv_r, int32_t extend,
+                             const uint32_t *ramp)
+{
+    __m128 x = _mm_add_ps(_mm_set1_ps((float)dx), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+    const __m128 step = _mm_set1_ps(4.0f);
+    const __m128 vdy2 = _mm_set1_ps(dy2);
+    const __m128 vinv_r = _mm_set1_ps(inv_r);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    int32_t idx[4];
+
+    int32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 t = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), vdy2)), vinv_r);
+        t = wrap_sse2(t, extend);
+        _mm_storeu_si128((__m128i *)idx, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, scale), half)));
+        dst[i + 0] = ramp[idx[0]];
+        dst[i + 1] = ramp[idx[1]];
+        dst[i + 2] = ramp[idx[2]];
+        dst[i + 3] = ramp[idx[3]];
+        x = _mm_add_ps(x, step);
+    }
+    radial_span_c(dst + i, count - i, dx + i, dy2, inv_r, extend, ramp);
+}
+
+AVX2 static inline __m256 wrap_avx2(__m256 t, int32_t extend)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    if (extend == LV_GRAD_EXTEND_REPEAT)
+        return _mm256_sub_ps(t, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(t)));
+    if (extend == LV_GRAD_EXTEND_REFLECT) {
+        __m256 u = _mm256_mul_ps(t, _mm256_set1_ps(0.5f));
+        u = _mm256_sub_ps(u, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(u)));
+        __m256 d = _mm256_sub_ps(_mm256_mul_ps(u, _mm256_set1_ps(2.0f)), one);
+        return _mm256_sub_ps(one, _mm256_andnot_ps(_mm256_set1_ps(-0.0f), d));
+    }
+    return _mm256_min_ps(t, one);
+}
+
+AVX2 static void radial_span_avx2(uint32_t *dst, int32_t count, int32_t dx, float dy2, float inv_r, int32_t extend,
+                                  const uint32_t *ramp)
+{
+    __m256 x = _mm256_add_ps(_mm256_set1_ps((float)dx), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+    const __m256 step = _mm256_set1_ps(8.0f);
+    const __m256 vdy2 = _mm256_set1_ps(dy2);
+    const __m256 vinv_r = _mm256_set1_ps(inv_r);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    int32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 t = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), vdy2)), vinv_r);
+        t = wrap_avx2(t, extend);
+        __m256i idx = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(t, scale), half));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_i32gather_epi32((const int *)ramp, idx, 4));
+        x = _mm256_add_ps(x, step);
+    }
+    radial_span_c(dst + i, count - i, dx + i, dy2, inv_r, extend, ramp);
+}
+
+#endif // GRAD_DRAW_SIMD
+
+// `count` pixels of row `y` of the gradient, starting at column `x`
+static void radial_span(uint32_t *dst, int32_t count, int32_t x, int32_t y, const grad_entry_t *e)
+{
+    const grad_key_t *key = &e->key;
+    int32_t dy = y - key->cy;
+    float dy2 = (float)(dy * dy);
+    float inv_r = 1.0f / (float)key->radius;
+
+#if GRAD_DRAW_SIMD
+    switch (blend_x86_get_level()) {
+    case BLEND_X86_AVX2:
+        radial_span_avx2(dst, count, x - key->cx, dy2, inv_r, key->extend, e->ramp);
+        return;
+    case BLEND_X86_SSE2:
+        radial_span_sse2(dst, count, x - key->cx, dy2, inv_r, key->extend, e->ramp);
+        return;
+    default:
+        break;
+    }
+#endif
+    radial_span_c(dst, count, x - key->cx, dy2, inv_r, key->extend, e->ramp);
+}
+
+// The cached ramp (and surface) for `key`, built on a miss. NULL if out of memory.
+static grad_entry_t *get_entry(const grad_key_t *key)
+{
+    grad_entry_t *e = lru_cache_lookup(&cache, key);
+    if (e) {
+        stats.hits++;
+        return e;
+    }
+
+    int32_t ramp_len = key->dir == LV_GRAD_DIR_HOR ? key->width :
+                       key->dir == LV_GRAD_DIR_VER ? key->height : RADIAL_STEPS;
+    size_t ramp_bytes = (size_t)ramp_len * sizeof(uint32_t);
+    size_t surface_bytes = 0;
+    if (key->dir != LV_GRAD_DIR_HOR && key->dir != LV_GRAD_DIR_VER) {
+        surface_bytes = (size_t)key->width * key->height * sizeof(uint32_t);
+        if (ramp_bytes + surface_bytes > GRAD_DRAW_CACHE_BYTES)
+            surface_bytes = 0;
+    }
+
+    e = lru_cache_insert(&cache, ramp_bytes + surface_bytes, &stats.evictions);
+    if (!e)
+        return NULL;
+    e->ramp = malloc(ramp_bytes);
+    e->surface = surface_bytes ? malloc(surface_bytes) : NULL;
+    if (!e->ramp || (surface_bytes && !e->surface)) {
+        lru_cache_drop(&cache, e);
+        return NULL;
+    }
+    e->key = *key;
+    e->ramp_len = ramp_len;
+    build_ramp(e->ramp, ramp_len, key);
+    for (int32_t y = 0; e->surface && y < key->height; y++)
+        radial_span(e->surface + (size_t)y * key->width, key->width, 0, y, e);
+
+    stats.misses++;
+    return e;
+}
+
+static void fill_row(uint32_t *dst, int32_t count, uint32_t color)
+{
+    for (int32_t i = 0; i < count; i++)
+        dst[i] = color;
+}
+
+static void draw_task(lv_layer_t *layer, const lv_draw_task_t *t, const grad_entry_t *e)
+{
+    lv_area_t area;
+    if (!lv_area_intersect(&area, &t->area, &t->clip_area) || !lv_area_intersect(&area, &area, &layer->buf_area))
+        return;
+
+    // The opaque pixels go straight into the layer, 0xFF in the X/alpha byte
+    int32_t width = lv_area_get_width(&area);
+    int32_t x = area.x1 - t->area.x1;
+    for (int32_t y = area.y1; y <= area.y2; y++) {
+        uint32_t *dst = (uint32_t *)lv_draw_buf_goto_xy(layer->draw_buf, area.x1 - layer->buf_area.x1,
+                                                        y - layer->buf_area.y1);
+        int32_t row = y - t->area.y1;
+        if (e->key.dir == LV_GRAD_DIR_HOR)
+            memcpy(dst, e->ramp + x, width * sizeof(uint32_t));
+        else if (e->key.dir == LV_GRAD_DIR_VER)
+            fill_row(dst, width, e->ramp[row]);
+        else if (e->surface)
+            memcpy(dst, e->surface + (size_t)row * e->key.width + x, width * sizeof(uint32_t));
+        else
+            radial_span(dst, width, x, row, e);
+    }
+
+    if (e->key.dir != LV_GRAD_DIR_HOR && e->key.dir != LV_GRAD_DIR_VER && !e->surface)
+        stats.uncached++;
+    stats.pixels += (uint64_t)width * lv_area_get_height(&area);
+}
+
+static bool can_draw(const lv_draw_task_t *t, grad_key_t *key)
+{
+    if (t->type != LV_DRAW_TASK_TYPE_FILL)
+        return false;
+
+    const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+    return dsc->opa >= LV_OPA_MAX && make_key(key, &dsc->grad, &t->area) &&
+           clear_of_corners(dsc->radius, &t->area, &t->clip_area);
+}
+
+static int32_t evaluate_cb(lv_draw_unit_t *draw_unit, lv_draw_task_t *t)
+{
+    grad_key_t key;
+    if (enabled && t->preference_score > GRAD_DRAW_PREFERENCE && can_draw(t, &key)) {
+        t->preference_score = GRAD_DRAW_PREFERENCE;
+        t->preferred_draw_unit_id = DRAW_UNIT_ID_GRAD;
+    }
+    return 0;
+}
+
+static int32_t dispatch_cb(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    // The next task that is ready to draw and was given to this unit
+    lv_draw_task_t *t = NULL;
+    do {
+        t = lv_draw_get_next_available_task(layer, t, DRAW_UNIT_ID_GRAD);
+    } while (t && t->preferred_draw_unit_id != DRAW_UNIT_ID_GRAD);
+    if (!t)
+        return LV_DRAW_UNIT_IDLE;
+
+    double start = now_ms();
+    grad_key_t key;
+    grad_entry_t *e = NULL;
+    if ((layer->color_format == LV_COLOR_FORMAT_XRGB8888 || layer->color_format == LV_COLOR_FORMAT_ARGB8888) &&
+        can_draw(t, &key) && lv_draw_layer_alloc_buf(layer))
+        e = get_entry(&key);
+    if (!e) {
+        t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+        return LV_DRAW_UNIT_IDLE;
+    }
+
+    t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+    draw_task(layer, t, e);
+    stats.fills++;
+    stats.ms += now_ms() - start;
+    t->state = LV_DRAW_TASK_STATE_READY;
+
+    lv_draw_dispatch_request();
+    return 1;
+}
+
+void grad_draw_init(void)
+{
+    if (!unit) {
+        unit = lv_draw_create_unit(sizeof(lv_draw_unit_t));
+        unit->evaluate_cb = evaluate_cb;
+        unit->dispatch_cb = dispatch_cb;
+    }
+    enabled = true;
+}
+
+void grad_draw_set_enabled(bool enable)
+{
+    enabled = enable && unit;
+    if (!enabled)
+        lru_cache_clear(&cache);
+}
+
+bool grad_draw_is_enabled(void)
+{
+    return enabled;
+}
+
+void grad_draw_get_stats(grad_draw_stats_t *out, bool reset)
+{
+    *out = stats;
+    out->cached_bytes = (uint32_t)cache.cached_bytes;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
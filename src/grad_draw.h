@@ -0,0 +1,45 @@
+#ifndef GRAD_DRAW_H
+#define GRAD_DRAW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// An LVGL draw unit for opaque gradient fills: horizontal, vertical and radial
+// gradients centred on their focal point (what lv_grad_radial_init sets up).
+//
+// Each gradient is turned into a color ramp once (one pixel per position for the
+// linear ones, 256 steps over the radius for radial ones) and kept in a small
+// LRU cache keyed by the gradient and the size of the object. Radial gradients
+// are additionally rendered into a full-size surface with a SIMD span renderer,
+// so repainting a dirty rect over any cached gradient is a row-by-row copy.
+//
+// Rounded fills are only taken where the drawn area stays clear of the corners;
+// the corners, translucent gradients and everything else stay with the SW unit.
+
+// Ramps plus surfaces; the least recently used entries are dropped beyond this
+#define GRAD_DRAW_CACHE_BYTES (32 * 1024 * 1024)
+#define GRAD_DRAW_CACHE_ENTRIES 8
+
+typedef struct {
+    uint32_t fills;
+    uint32_t hits;
+    uint32_t misses;        // ramps (and surfaces) built
+    uint32_t evictions;
+    uint32_t uncached;      // radial fills rendered span by span, the surface would not fit
+    uint32_t cached_bytes;
+    uint64_t pixels;
+    double ms;              // drawing, including building ramps and surfaces
+} grad_draw_stats_t;
+
+// Call after lv_init(). The span renderer uses the SIMD level of blend_x86.h
+// when built with LVGL_GLFW_SIMD, plain C otherwise.
+void grad_draw_init(void);
+
+// While disabled the unit takes no gradients and keeps no ramps or surfaces.
+void grad_draw_set_enabled(bool enabled);
+bool grad_draw_is_enabled(void);
+
+// Call on the thread LVGL runs on; the unit counts there without locking.
+void grad_draw_get_stats(grad_draw_stats_t *stats, bool reset);
+
+#endif // GRAD_DRAW_H
@@ -0,0 +1,387 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "hud.h"
+#include "gl_ext.h"
+#include "gl_shader.h"
+#include "gl_upload.h"
+#include "presenter.h"
+
+#define ATTRIB_POS 0
+#define ATTRIB_UV 1
+#define ATTRIB_COLOR 2
+
+#define ATLAS_WIDTH 256
+#define ATLAS_HEIGHT 8
+#define CELL_WIDTH 6            // 5x7 glyphs with a column and a row of spacing
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+#define MAX_QUADS 512
+#define GRAPH_HEIGHT 60         // [window px]
+#define GRAPH_MAX_MS 50.0
+#define PADDING 8
+#define LINE_HEIGHT ((ATLAS_HEIGHT + 2) * HUD_SCALE)
+#define LINES 3
+
+static const char *vertex_src =
+    "ATTRIBUTE vec2 a_pos;\n"
+    "ATTRIBUTE vec2 a_uv;\n"
+    "ATTRIBUTE vec4 a_color;\n"
+    "VARYING_OUT vec2 v_uv;\n"
+    "VARYING_OUT vec4 v_color;\n"
+    "void main() {\n"
+    "    v_uv = a_uv;\n"
+    "    v_color = a_color;\n"
+    "    gl_Position = vec4(a_pos, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *fragment_src =
+    "uniform sampler2D u_atlas;\n"
+    "VARYING_IN vec2 v_uv;\n"
+    "VARYING_IN vec4 v_color;\n"
+    "void main() {\n"
+    "    FRAG_COLOR = vec4(v_color.rgb, v_color.a * TEXTURE(u_atlas, v_uv).a);\n"
+    "}\n";
+
+// The characters the HUD prints, in atlas order; the cell after the last is solid
+static const char glyph_chars[] = "0123456789./%-ABDEFHIKLMOPSU";
+
+// Rows top down, bit 4 is the leftmost pixel
+static const uint8_t glyph_rows[][GLYPH_HEIGHT] = {
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },   // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },   // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },   // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },   // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },   // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },   // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },   // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },   // 9
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },   // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // /
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // %
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // -
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },   // B
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },   // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },   // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },   // F
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // I
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },   // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },   // M
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },   // P
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },   // S
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // U
+};
+
+#define GLYPH_COUNT ((int)sizeof(glyph_chars) - 1)
+#define SOLID_CELL GLYPH_COUNT
+
+typedef struct {
+    GLfloat x, y;           // clip space
+    GLfloat u, v;
+    GLubyte color[4];
+} vertex_t;
+
+typedef struct {
+    GLubyte r, g, b, a;
+} rgba_t;
+
+static bool enabled;
+static bool use_shader;
+static GLuint atlas;
+static GLuint program;
+static GLuint vao;
+static GLuint vbo;
+static vertex_t vertices[MAX_QUADS * 6];
+static int vertex_count;
+static float clip_x;        // window pixels to clip space
+static float clip_y;
+
+// Main thread
+static float history[HUD_HISTORY];  // [ms] between presents, oldest first from history_next
+static int history_next;
+static double last_present;
+static double window_start;
+static uint32_t window_frames;
+static uint64_t window_bytes;
+static uint64_t last_bytes;
+static double shown_fps;
+static double shown_ms;
+static double shown_kib;
+
+// Written where LVGL runs, read by the main thread
+static atomic_uint heap_used;
+static atomic_uint heap_total;
+static double last_heap_sample;
+
+static void build_atlas(void)
+{
+    static uint8_t pixels[ATLAS_HEIGHT][ATLAS_WIDTH][4];
+    memset(pixels, 0, sizeof(pixels));
+    for (int i = 0; i <= GLYPH_COUNT; i++) {
+        for (int y = 0; y < ATLAS_HEIGHT; y++) {
+            for (int x = 0; x < CELL_WIDTH; x++) {
+                bool set = i == SOLID_CELL ||
+                           (y < GLYPH_HEIGHT && x < GLYPH_WIDTH && (glyph_rows[i][y] >> (GLYPH_WIDTH - 1 - x)) & 1);
+                uint8_t *px = pixels[y][i * CELL_WIDTH + x];
+                px[0] = px[1] = px[2] = 255;
+                px[3] = set ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);  // the uploads leave it at the frame width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+static void bind_attribs(void)
+{
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_ext.EnableVertexAttribArray(ATTRIB_POS);
+    gl_ext.VertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (const void *)offsetof(vertex_t, x));
+    gl_ext.EnableVertexAttribArray(ATTRIB_UV);
+    gl_ext.VertexAttribPointer(ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (const void *)offsetof(vertex_t, u));
+    gl_ext.EnableVertexAttribArray(ATTRIB_COLOR);
+    gl_ext.VertexAttribPointer(ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(vertex_t),
+                               (const void *)offsetof(vertex_t, color));
+}
+
+// Two triangles, `cell` stretched over the window rectangle x, y, w, h
+static void add_quad(float x, float y, float w, float h, int cell, rgba_t color)
+{
+    if (vertex_count + 6 > MAX_QUADS * 6)
+        return;
+
+    float u0 = (float)(cell * CELL_WIDTH) / ATLAS_WIDTH;
+    float u1 = (float)(cell * CELL_WIDTH + GLYPH_WIDTH) / ATLAS_WIDTH;
+    float v1 = (float)GLYPH_HEIGHT / ATLAS_HEIGHT;
+    if (cell == SOLID_CELL) {
+        // Sample the middle of the solid cell only
+        u0 = u1 = (cell * CELL_WIDTH + CELL_WIDTH / 2.0f) / ATLAS_WIDTH;
+        v1 = 0.5f;
+    }
+    float v0 = cell == SOLID_CELL ? v1 : 0.0f;
+
+    float x0 = x * clip_x - 1.0f, x1 = (x + w) * clip_x - 1.0f;
+    float y0 = 1.0f - y * clip_y, y1 = 1.0f - (y + h) * clip_y;
+    const vertex_t corners[4] = {
+        { x0, y0, u0, v0, { color.r, color.g, color.b, color.a } },
+        { x1, y0, u1, v0, { color.r, color.g, color.b, color.a } },
+        { x1, y1, u1, v1, { color.r, color.g, color.b, color.a } },
+        { x0, y1, u0, v1, { color.r, color.g, color.b, color.a } },
+    };
+    static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i = 0; i < 6; i++)
+        vertices[vertex_count++] = corners[order[i]];
+}
+
+static void add_text(float x, float y, const char *text, rgba_t color)
+{
+    for (; *text; text++, x += CELL_WIDTH * HUD_SCALE) {
+        const char *glyph = strchr(glyph_chars, *text);
+        if (*text != ' ' && glyph)
+            add_quad(x, y, GLYPH_WIDTH * HUD_SCALE, GLYPH_HEIGHT * HUD_SCALE, (int)(glyph - glyph_chars), color);
+    }
+}
+
+static void build(int32_t width, int32_t height)
+{
+    static const rgba_t background = { 0, 0, 0, 160 };
+    static const rgba_t text = { 255, 255, 255, 255 };
+    static const rgba_t guide = { 255, 255, 255, 64 };
+    static const rgba_t fast = { 80, 220, 100, 255 };
+    static const rgba_t slow = { 240, 200, 60, 255 };
+    static const rgba_t late = { 240, 70, 60, 255 };
+
+    clip_x = 2.0f / width;
+    clip_y = 2.0f / height;
+    vertex_count = 0;
+
+    float graph_width = HUD_HISTORY * HUD_SCALE;
+    float panel_width = graph_width + 2 * PADDING;
+    float panel_height = LINES * LINE_HEIGHT + GRAPH_HEIGHT + 3 * PADDING;
+    float x = width - panel_width - PADDING;
+    float y = PADDING;
+    add_quad(x, y, panel_width, panel_height, SOLID_CELL, background);
+    x += PADDING;
+    y += PADDING;
+
+    char line[32];
+    snprintf(line, sizeof(line), "FPS %.1f %.1f MS", shown_fps, shown_ms);
+    add_text(x, y, line, text);
+    snprintf(line, sizeof(line), "UPLOAD %.1f KIB", shown_kib);
+    add_text(x, y + LINE_HEIGHT, line, text);
+    unsigned used = atomic_load_explicit(&heap_used, memory_order_relaxed);
+    unsigned total = atomic_load_explicit(&heap_total, memory_order_relaxed);
+    if (total)
+        snprintf(line, sizeof(line), "HEAP %.1f KIB %u%%", used / 1024.0, (unsigned)(100.0 * used / total));
+    else
+        snprintf(line, sizeof(line), "HEAP -");
+    add_text(x, y + 2 * LINE_HEIGHT, line, text);
+
+    // Frame times as bars, newest on the right, with guides at one and two 60 Hz periods
+    float bottom = y + LINES * LINE_HEIGHT + PADDING + GRAPH_HEIGHT;
+    float px_per_ms = GRAPH_HEIGHT / GRAPH_MAX_MS;
+    add_quad(x, bottom - 16.7f * px_per_ms, graph_width, 1, SOLID_CELL, guide);
+    add_quad(x, bottom - 33.3f * px_per_ms, graph_width, 1, SOLID_CELL, guide);
+    for (int i = 0; i < HUD_HISTORY; i++) {
+        float ms = history[(history_next + i) % HUD_HISTORY];
+        if (ms <= 0.0f)
+            continue;
+        float h = (ms < GRAPH_MAX_MS ? ms : (float)GRAPH_MAX_MS) * px_per_ms;
+        add_quad(x + i * HUD_SCALE, bottom - h, HUD_SCALE, h, SOLID_CELL, ms <= 17.5f ? fast : ms <= 34.0f ? slow : late);
+    }
+}
+
+static void hud_draw(int32_t width, int32_t height)
+{
+    build(width, height);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (use_shader) {
+        gl_ext.UseProgram(program);
+        gl_ext.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        if (vao)
+            gl_ext.BindVertexArray(vao);
+        else
+            bind_attribs();
+        gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+        gl_ext.BufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(vertex_t), vertices, GL_STREAM_DRAW);
+        glDrawArrays(GL_TRIANGLES, 0, vertex_count);
+        if (vao)
+            gl_ext.BindVertexArray(0);
+        else if (gl_ext.DisableVertexAttribArray)
+            gl_ext.DisableVertexAttribArray(ATTRIB_COLOR);  // the presenter's quads have no colors
+        gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+        gl_ext.UseProgram(0);
+    }
+    else {
+        // The texture environment modulates: the vertex color, with the glyph as its alpha
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glBegin(GL_TRIANGLES);
+        for (int i = 0; i < vertex_count; i++) {
+            const vertex_t *v = &vertices[i];
+            glColor4ub(v->color[0], v->color[1], v->color[2], v->color[3]);
+            glTexCoord2f(v->u, v->v);
+            glVertex2f(v->x, v->y);
+        }
+        glEnd();
+        glColor4ub(255, 255, 255, 255);  // the presenter's quads are modulated by it too
+        glDisable(GL_TEXTURE_2D);
+    }
+    glDisable(GL_BLEND);
+}
+
+bool hud_init(void)
+{
+    use_shader = presenter_uses_shader();
+    if (use_shader) {
+        static const char * const attribs[] = { "a_pos", "a_uv", "a_color" };  // ATTRIB_POS, ATTRIB_UV, ATTRIB_COLOR
+        program = gl_shader_build(vertex_src, fragment_src, attribs, 3);
+        if (!program)
+            return false;
+        gl_ext.UseProgram(program);
+        gl_ext.Uniform1i(gl_ext.GetUniformLocation(program, "u_atlas"), 0);
+        gl_ext.UseProgram(0);
+
+        gl_ext.GenBuffers(1, &vbo);
+        if (gl_ext.vao) {
+            gl_ext.GenVertexArrays(1, &vao);
+            gl_ext.BindVertexArray(vao);
+            bind_attribs();
+            gl_ext.BindVertexArray(0);
+        }
+        gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    build_atlas();
+
+    memset(history, 0, sizeof(history));
+    history_next = 0;
+    last_present = window_start = glfwGetTime();
+    window_frames = 0;
+    window_bytes = 0;
+    last_bytes = 0;
+    shown_fps = shown_ms = shown_kib = 0.0;
+    last_heap_sample = 0.0;
+
+    presenter_set_overlay(hud_draw);
+    enabled = true;
+    return true;
+}
+
+void hud_deinit(void)
+{
+    if (!enabled)
+        return;
+
+    presenter_set_overlay(NULL);
+    if (vao)
+        gl_ext.DeleteVertexArrays(1, &vao);
+    if (vbo)
+        gl_ext.DeleteBuffers(1, &vbo);
+    if (program)
+        gl_ext.DeleteProgram(program);
+    glDeleteTextures(1, &atlas);
+    vao = vbo = program = atlas = 0;
+    enabled = false;
+}
+
+void hud_frame_presented(void)
+{
+    if (!enabled)
+        return;
+
+    double now = glfwGetTime();
+    history[history_next] = (float)((now - last_present) * 1000.0);
+    history_next = (history_next + 1) % HUD_HISTORY;
+    last_present = now;
+
+    // Upload bytes only grow between --stats resets
+    gl_upload_stats_t st;
+    gl_upload_get_stats(&st, false);
+    window_bytes += st.bytes >= last_bytes ? st.bytes - last_bytes : st.bytes;
+    last_bytes = st.bytes;
+    window_frames++;
+
+    double elapsed = now - window_start;
+    if (elapsed >= HUD_UPDATE_S) {
+        shown_fps = window_frames / elapsed;
+        shown_ms = elapsed * 1000.0 / window_frames;
+        shown_kib = window_bytes / 1024.0 / window_frames;
+        window_start = now;
+        window_frames = 0;
+        window_bytes = 0;
+    }
+}
+
+void hud_sample_heap(void)
+{
+    if (!enabled)
+        return;
+
+    double now = glfwGetTime();
+    if (now - last_heap_sample < HUD_UPDATE_S)
+        return;
+    last_heap_sample = now;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    atomic_store_explicit(&heap_used, (unsigned)(mon.total_size - mon.free_size), memory_order_relaxed);
+    atomic_store_explicit(&heap_total, (unsigned)mon.total_size, memory_order_relaxed);
+}
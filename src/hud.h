@@ -0,0 +1,31 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A performance overlay the presenter draws over the LVGL quad: frames per
+// second, a graph of recent frame times, texture upload bytes per frame and
+// LVGL heap use. It has its own 5x7 glyph atlas and vertex buffer and never
+// touches LVGL's objects, so showing it causes no invalidation, rendering or
+// upload. It is redrawn with the frames the loop presents anyway; an idle UI
+// keeps the last figures on screen.
+
+#define HUD_HISTORY 120         // frames in the graph
+#define HUD_UPDATE_S 0.5        // figures are averaged over and refreshed this often
+#define HUD_SCALE 2             // atlas pixels to window pixels
+
+// Context thread, after presenter_init: builds the atlas and, with shaders,
+// the program; registers hud_draw as the presenter's overlay. Returns false if
+// the presenter's path cannot draw it.
+bool hud_init(void);
+void hud_deinit(void);
+
+// Main thread, after each swap.
+void hud_frame_presented(void);
+
+// Call on the thread LVGL runs on, e.g. after lv_timer_handler. The heap is
+// sampled at most every HUD_UPDATE_S.
+void hud_sample_heap(void);
+
+#endif // HUD_H
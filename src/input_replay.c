@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GLFW/glfw3.h>
+#include "input_replay.h"
+#include "percentile.h"
+
+#define MAGIC "LVINPUT"
+#define HEADER_SIZE 16
+#define RECORD_SIZE 16
+
+typedef struct {
+    uint32_t tick;
+    uint32_t events;    // delivered at the start of the frame
+    bool presented;
+    float lvgl_ms;
+    float present_ms;
+} frame_t;
+
+// Recording, on the LVGL thread once started
+static FILE *record_file;
+static double record_start;
+
+// Replay, on the thread LVGL runs on
+static bool replaying;
+static app_event_t *events;
+static uint32_t event_count;
+static uint32_t next_event;
+static uint32_t tick;
+static bool started;
+static frame_t *frames;
+static uint32_t frame_count;
+static uint32_t frame_capacity;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+bool input_record_start(const char *path, int32_t width, int32_t height)
+{
+    record_file = fopen(path, "wb");
+    if (!record_file)
+        return false;
+
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, MAGIC, 7);
+    header[7] = INPUT_REPLAY_VERSION;
+    put_u32(header + 8, (uint32_t)width);
+    put_u32(header + 12, (uint32_t)height);
+    fwrite(header, sizeof(header), 1, record_file);
+    record_start = glfwGetTime();
+    return true;
+}
+
+void input_record_stop(void)
+{
+    if (!record_file)
+        return;
+    if (fclose(record_file) != 0)
+        fprintf(stderr, "Could not finish writing the input recording\n");
+    record_file = NULL;
+}
+
+bool input_record_is_enabled(void)
+{
+    return record_file != NULL;
+}
+
+void input_record_event(const app_event_t *event)
+{
+    if (!record_file)
+        return;
+
+    // Microseconds cover a session of a little over an hour
+    double offset = (event->time - record_start) * 1e6;
+    uint8_t record[RECORD_SIZE] = { 0 };
+    put_u32(record, offset <= 0.0 ? 0 : offset >= UINT32_MAX ? UINT32_MAX : (uint32_t)offset);
+    record[4] = (uint8_t)event->type;
+    record[5] = event->pressed;
+    put_u16(record + 8, (uint16_t)(int16_t)event->x);
+    put_u16(record + 10, (uint16_t)(int16_t)event->y);
+    put_u32(record + 12, event->key);
+    fwrite(record, sizeof(record), 1, record_file);
+}
+
+bool input_replay_open(const char *path, int32_t *width, int32_t *height)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    uint8_t header[HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, file) != 1 || memcmp(header, MAGIC, 7) != 0 ||
+        header[7] != INPUT_REPLAY_VERSION) {
+        fclose(file);
+        return false;
+    }
+    *width = (int32_t)get_u32(header + 8);
+    *height = (int32_t)get_u32(header + 12);
+
+    uint8_t record[RECORD_SIZE];
+    uint32_t capacity = 0;
+    event_count = 0;
+    while (fread(record, sizeof(record), 1, file) == 1) {
+        if (event_count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            app_event_t *grown = realloc(events, capacity * sizeof(app_event_t));
+            if (!grown) {
+                fclose(file);
+                input_replay_close();
+                return false;
+            }
+            events = grown;
+        }
+
+        // Times become ticks of the virtual clock, which starts where the recording did
+        uint32_t offset_us = get_u32(record);
+        events[event_count++] = (app_event_t){
+            .type = (app_event_type_t)record[4],
+            .pressed = record[5] != 0,
+            .x = (int16_t)get_u16(record + 8),
+            .y = (int16_t)get_u16(record + 10),
+            .key = get_u32(record + 12),
+            .timestamp = offset_us / 1000,
+            .time = offset_us / 1e6,
+        };
+    }
+    fclose(file);
+
+    next_event = 0;
+    tick = 0;
+    started = false;
+    frame_count = 0;
+    replaying = true;
+    return true;
+}
+
+void input_replay_close(void)
+{
+    replaying = false;
+    free(events);
+    free(frames);
+    events = NULL;
+    frames = NULL;
+    event_count = frame_count = frame_capacity = 0;
+}
+
+bool input_replay_is_active(void)
+{
+    return replaying;
+}
+
+uint32_t input_replay_tick(void)
+{
+    return tick;
+}
+
+bool input_replay_next_frame(uint32_t step_ms, void (*inject)(const app_event_t *event))
+{
+    if (started)
+        tick += step_ms;
+    started = true;
+
+    uint32_t last = event_count ? events[event_count - 1].timestamp : 0;
+    if (next_event == event_count && tick > last + INPUT_REPLAY_SETTLE_MS)
+        return false;
+
+    uint32_t delivered = 0;
+    while (next_event < event_count && events[next_event].timestamp <= tick) {
+        inject(&events[next_event++]);
+        delivered++;
+    }
+
+    if (frame_count == frame_capacity && frame_capacity < INPUT_REPLAY_MAX_FRAMES) {
+        uint32_t capacity = frame_capacity ? frame_capacity * 2 : 1024;
+        frame_t *grown = realloc(frames, capacity * sizeof(frame_t));
+        if (grown) {
+            frames = grown;
+            frame_capacity = capacity;
+        }
+    }
+    if (frame_count < frame_capacity)
+        frames[frame_count] = (frame_t){ .tick = tick, .events = delivered };
+    return true;
+}
+
+void input_replay_frame_done(double lvgl_ms, double present_ms, bool presented)
+{
+    if (frame_count == frame_capacity)
+        return;
+
+    frame_t *frame = &frames[frame_count++];
+    frame->lvgl_ms = (float)lvgl_ms;
+    frame->present_ms = (float)present_ms;
+    frame->presented = presented;
+}
+
+void input_replay_get_stats(input_replay_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->events = next_event;
+    out->frames = frame_count;
+
+    double *sorted = frame_count ? malloc(frame_count * sizeof(double)) : NULL;
+    if (!sorted)
+        return;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        sorted[i] = frames[i].lvgl_ms + frames[i].present_ms;
+        if (frames[i].presented)
+            out->presented++;
+        if (sorted[i] > out->max) {
+            out->max = sorted[i];
+            out->max_frame = i;
+            out->max_tick = frames[i].tick;
+        }
+    }
+    percentile_sort(sorted, frame_count);
+    out->p50 = percentile(sorted, frame_count, 0.50);
+    out->p95 = percentile(sorted, frame_count, 0.95);
+    out->p99 = percentile(sorted, frame_count, 0.99);
+    free(sorted);
+}
+
+int input_replay_write_trace(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return -1;
+
+    fprintf(file, "frame,tick_ms,events,lvgl_ms,present_ms,presented\n");
+    for (uint32_t i = 0; i < frame_count; i++) {
+        const frame_t *f = &frames[i];
+        fprintf(file, "%u,%u,%u,%.3f,%.3f,%d\n", i, f->tick, f->events, f->lvgl_ms, f->present_ms, f->presented);
+    }
+    return fclose(file) == 0 ? (int)frame_count : -1;
+}
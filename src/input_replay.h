@@ -0,0 +1,73 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "event_queue.h"
+
+// Input sessions recorded to a file and replayed on a deterministic clock, so
+// an interaction that causes slow frames can be run again before and after a
+// change.
+//
+// The recorder logs the events the indevs hand to LVGL, after coalescing, with
+// their time since recording started. The file is a 16 byte header ("LVINPUT",
+// a format version, the frame width and height) followed by one 16 byte record
+// per event, all little endian.
+//
+// Replay runs LVGL on a virtual clock instead: it starts at 0 and advances by a
+// fixed step per frame, and each recorded event is delivered in the first frame
+// whose tick has reached it. Every frame's render and present time is kept for
+// a frame-time trace.
+
+#define INPUT_REPLAY_VERSION 1
+#define INPUT_REPLAY_STEP_MS 16         // virtual time per replayed frame
+#define INPUT_REPLAY_SETTLE_MS 1000     // frames kept running after the last event
+#define INPUT_REPLAY_MAX_FRAMES (1024 * 1024)  // kept for input_replay_write_trace
+
+// Call before lv_init, so the recorded times and LVGL's start line up as in a
+// replay. Returns false if the file could not be created.
+bool input_record_start(const char *path, int32_t width, int32_t height);
+void input_record_stop(void);
+bool input_record_is_enabled(void);
+
+// LVGL thread: an indev read consumed `event`.
+void input_record_event(const app_event_t *event);
+
+// Load a recording, also before lv_init. Returns false if it cannot be read;
+// `width` and `height` are the frame size it was recorded at.
+bool input_replay_open(const char *path, int32_t *width, int32_t *height);
+void input_replay_close(void);
+bool input_replay_is_active(void);
+
+// The virtual clock, LVGL's tick while replaying.
+uint32_t input_replay_tick(void);
+
+// Start the next frame: advance the clock by `step_ms` (not for the first) and
+// pass every event due by then to `inject`. Returns false once the last event
+// was delivered and INPUT_REPLAY_SETTLE_MS have passed.
+bool input_replay_next_frame(uint32_t step_ms, void (*inject)(const app_event_t *event));
+
+// The frame begun by input_replay_next_frame took `lvgl_ms` in LVGL (input,
+// timers, rendering, uploads) and `present_ms` to present, 0 if it presented
+// nothing.
+void input_replay_frame_done(double lvgl_ms, double present_ms, bool presented);
+
+typedef struct {
+    uint32_t events;        // recorded events delivered
+    uint32_t frames;
+    uint32_t presented;
+    double p50;             // [ms] LVGL plus present, per frame
+    double p95;
+    double p99;
+    double max;
+    uint32_t max_frame;     // the worst frame
+    uint32_t max_tick;      // ...and its tick
+} input_replay_stats_t;
+
+void input_replay_get_stats(input_replay_stats_t *stats);
+
+// Every frame as CSV. Returns the number of rows written, -1 if the file could
+// not be written.
+int input_replay_write_trace(const char *path);
+
+#endif // INPUT_REPLAY_H
@@ -0,0 +1,304 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GLFW/glfw3.h>
+#include "latency_trace.h"
+#include "percentile.h"
+
+#define STALE_S 1.0  // a read the display never refreshed after (its timer pauses while idle)
+
+typedef enum {
+    TRACE_FREE,
+    TRACE_READ,         // waiting for an invalidation
+    TRACE_INVALIDATED,  // waiting for a flush covering `area`
+    TRACE_FLUSHING,     // covered; the frame is not complete yet
+    TRACE_FLUSHED,      // frame `frame` complete, waiting for it to be presented
+} trace_state_t;
+
+typedef struct {
+    trace_state_t state;
+    double input;       // [s] glfwGetTime
+    double read;
+    double invalidate;
+    double flush;
+    lv_area_t area;
+    uint32_t frame;
+} trace_t;
+
+typedef struct {
+    double input;       // [s] glfwGetTime
+    float read;         // [ms] after input
+    float invalidate;
+    float flush;
+    float present;
+} record_t;
+
+typedef struct {
+    record_t *records;
+    uint32_t count;
+    uint32_t capacity;
+} record_list_t;
+
+// Flushes happen on the LVGL thread, swaps on the main thread, which differ in
+// threaded mode; all state is behind one lock
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static bool enabled;
+static lv_display_t *display;
+static trace_t traces[LATENCY_TRACE_IN_FLIGHT];
+static uint32_t frames;
+static double refr_start;
+static record_list_t all;       // for latency_trace_write
+static record_list_t interval;  // since the last stats reset
+
+static struct {
+    uint32_t traced;
+    uint32_t presented;
+    uint32_t no_redraw;
+    uint32_t overflow;
+} stats;
+
+static void drop_no_redraw(trace_t *trace)
+{
+    trace->state = TRACE_FREE;
+    stats.no_redraw++;
+}
+
+static void display_event_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    double now = glfwGetTime();
+
+    pthread_mutex_lock(&lock);
+    if (code == LV_EVENT_INVALIDATE_AREA) {
+        const lv_area_t *area = lv_event_get_param(e);
+        for (int i = 0; i < LATENCY_TRACE_IN_FLIGHT; i++) {
+            trace_t *trace = &traces[i];
+            if (trace->state == TRACE_READ) {
+                trace->state = TRACE_INVALIDATED;
+                trace->invalidate = now;
+                trace->area = *area;
+            }
+            else if (trace->state == TRACE_INVALIDATED) {
+                lv_area_join(&trace->area, &trace->area, area);
+            }
+        }
+    }
+    else if (code == LV_EVENT_REFR_START) {
+        refr_start = now;
+    }
+    else if (code == LV_EVENT_REFR_READY) {
+        // A whole refresh went by since the read without anything to show for it
+        for (int i = 0; i < LATENCY_TRACE_IN_FLIGHT; i++) {
+            if (traces[i].state == TRACE_READ && traces[i].read < refr_start)
+                drop_no_redraw(&traces[i]);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void latency_trace_init(lv_display_t *disp)
+{
+    pthread_mutex_lock(&lock);
+    memset(traces, 0, sizeof(traces));
+    memset(&stats, 0, sizeof(stats));
+    frames = 0;
+    refr_start = 0.0;
+    display = disp;
+    enabled = true;
+    pthread_mutex_unlock(&lock);
+
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_REFR_READY, NULL);
+}
+
+void latency_trace_deinit(void)
+{
+    if (!enabled)
+        return;
+
+    lv_display_remove_event_cb_with_user_data(display, display_event_cb, NULL);
+
+    pthread_mutex_lock(&lock);
+    enabled = false;
+    free(all.records);
+    free(interval.records);
+    memset(&all, 0, sizeof(all));
+    memset(&interval, 0, sizeof(interval));
+    pthread_mutex_unlock(&lock);
+}
+
+bool latency_trace_is_enabled(void)
+{
+    return enabled;
+}
+
+void latency_trace_input(double time)
+{
+    double now = glfwGetTime();
+
+    pthread_mutex_lock(&lock);
+    stats.traced++;
+
+    trace_t *slot = NULL;
+    trace_t *oldest = NULL;
+    for (int i = 0; i < LATENCY_TRACE_IN_FLIGHT; i++) {
+        trace_t *trace = &traces[i];
+        if (trace->state == TRACE_READ && now - trace->read > STALE_S)
+            drop_no_redraw(trace);
+        if (trace->state == TRACE_FREE) {
+            if (!slot)
+                slot = trace;
+        }
+        else if (!oldest || trace->input < oldest->input) {
+            oldest = trace;
+        }
+    }
+    if (!slot) {
+        slot = oldest;
+        stats.overflow++;
+    }
+
+    *slot = (trace_t){ .state = TRACE_READ, .input = time, .read = now };
+    pthread_mutex_unlock(&lock);
+}
+
+void latency_trace_flush(const lv_area_t *area, bool last)
+{
+    double now = glfwGetTime();
+    lv_area_t common;
+
+    pthread_mutex_lock(&lock);
+    if (last)
+        frames++;
+
+    for (int i = 0; i < LATENCY_TRACE_IN_FLIGHT; i++) {
+        trace_t *trace = &traces[i];
+        if (trace->state == TRACE_INVALIDATED && lv_area_intersect(&common, &trace->area, area))
+            trace->state = TRACE_FLUSHING;
+        if (!last)
+            continue;
+
+        if (trace->state == TRACE_FLUSHING) {
+            trace->state = TRACE_FLUSHED;
+            trace->flush = now;
+            trace->frame = frames;
+        }
+        else if (trace->state == TRACE_INVALIDATED && trace->invalidate < refr_start) {
+            // Invalidated before this refresh, yet nothing it covered was flushed (off screen)
+            drop_no_redraw(trace);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+uint32_t latency_trace_get_frames(void)
+{
+    pthread_mutex_lock(&lock);
+    uint32_t count = frames;
+    pthread_mutex_unlock(&lock);
+    return count;
+}
+
+static void append(record_list_t *list, const record_t *record, uint32_t limit)
+{
+    if (list->count == list->capacity) {
+        if (list->capacity >= limit)
+            return;
+        uint32_t capacity = list->capacity ? list->capacity * 2 : 256;
+        record_t *records = realloc(list->records, capacity * sizeof(record_t));
+        if (!records)
+            return;
+        list->records = records;
+        list->capacity = capacity;
+    }
+    list->records[list->count++] = *record;
+}
+
+void latency_trace_present(uint32_t frame)
+{
+    double now = glfwGetTime();
+
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < LATENCY_TRACE_IN_FLIGHT; i++) {
+        trace_t *trace = &traces[i];
+        if (trace->state != TRACE_FLUSHED || (int32_t)(frame - trace->frame) < 0)
+            continue;
+
+        record_t record = {
+            .input = trace->input,
+            .read = (float)((trace->read - trace->input) * 1000.0),
+            .invalidate = (float)((trace->invalidate - trace->input) * 1000.0),
+            .flush = (float)((trace->flush - trace->input) * 1000.0),
+            .present = (float)((now - trace->input) * 1000.0),
+        };
+        append(&all, &record, LATENCY_TRACE_MAX_RECORDS);
+        append(&interval, &record, LATENCY_TRACE_MAX_RECORDS);
+        trace->state = TRACE_FREE;
+        stats.presented++;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+// One record field of every record, sorted
+static void sort_field(const record_list_t *list, size_t offset, double *scratch)
+{
+    for (uint32_t i = 0; i < list->count; i++)
+        scratch[i] = *(const float *)((const uint8_t *)&list->records[i] + offset);
+    percentile_sort(scratch, list->count);
+}
+
+void latency_trace_get_stats(latency_trace_stats_t *out, bool reset)
+{
+    memset(out, 0, sizeof(*out));
+
+    pthread_mutex_lock(&lock);
+    out->traced = stats.traced;
+    out->presented = stats.presented;
+    out->no_redraw = stats.no_redraw;
+    out->overflow = stats.overflow;
+
+    // Sorting is on the reporting path only, once per interval
+    uint32_t n = interval.count;
+    double *scratch = n ? malloc(n * sizeof(double)) : NULL;
+    if (scratch) {
+        sort_field(&interval, offsetof(record_t, present), scratch);
+        out->p50 = percentile(scratch, n, 0.50);
+        out->p95 = percentile(scratch, n, 0.95);
+        out->p99 = percentile(scratch, n, 0.99);
+        out->max = scratch[n - 1];
+        sort_field(&interval, offsetof(record_t, read), scratch);
+        out->read_p50 = percentile(scratch, n, 0.50);
+        sort_field(&interval, offsetof(record_t, invalidate), scratch);
+        out->invalidate_p50 = percentile(scratch, n, 0.50);
+        sort_field(&interval, offsetof(record_t, flush), scratch);
+        out->flush_p50 = percentile(scratch, n, 0.50);
+        free(scratch);
+    }
+
+    if (reset) {
+        memset(&stats, 0, sizeof(stats));
+        interval.count = 0;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+int latency_trace_write(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return -1;
+
+    pthread_mutex_lock(&lock);
+    fprintf(file, "input_s,read_ms,invalidate_ms,flush_ms,present_ms\n");
+    for (uint32_t i = 0; i < all.count; i++) {
+        const record_t *r = &all.records[i];
+        fprintf(file, "%.6f,%.3f,%.3f,%.3f,%.3f\n", r->input, r->read, r->invalidate, r->flush, r->present);
+    }
+    int rows = (int)all.count;
+    pthread_mutex_unlock(&lock);
+
+    return fclose(file) == 0 ? rows : -1;
+}
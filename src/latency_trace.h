@@ -0,0 +1,62 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// Input-to-photon latency: each input event an indev read hands to LVGL is
+// followed from the GLFW callback that reported it, through the invalidation
+// its dispatch causes on the display and the flush whose areas cover it, to the
+// glfwSwapBuffers that shows the frame. Pointer motion is only traced while the
+// button is held; hovering rarely redraws anything.
+//
+// An event is credited with what is invalidated between its read and the next
+// refresh, so an animation invalidating in that window is counted as its
+// effect. Events that invalidate nothing by then count as `no_redraw`. The swap
+// returning is the last point visible here: with vsync the photons follow at
+// the next scanout.
+
+#define LATENCY_TRACE_IN_FLIGHT 32      // events followed at once; the oldest is dropped beyond
+#define LATENCY_TRACE_MAX_RECORDS (256 * 1024)  // kept for latency_trace_write
+
+typedef struct {
+    uint32_t traced;        // events handed to LVGL
+    uint32_t presented;     // ...that reached a swap
+    uint32_t no_redraw;
+    uint32_t overflow;      // dropped with too many in flight
+    double p50;             // [ms] GLFW callback to swap
+    double p95;
+    double p99;
+    double max;
+    double read_p50;        // [ms] GLFW callback to each stage, medians
+    double invalidate_p50;
+    double flush_p50;
+} latency_trace_stats_t;
+
+// Call after the display is created, on the thread LVGL runs on.
+void latency_trace_init(lv_display_t *disp);
+void latency_trace_deinit(void);
+bool latency_trace_is_enabled(void);
+
+// LVGL thread: an indev read consumed an event GLFW reported at `time`
+// (glfwGetTime seconds).
+void latency_trace_input(double time);
+
+// LVGL thread, from the flush callback.
+void latency_trace_flush(const lv_area_t *area, bool last);
+
+// Frames completed by latency_trace_flush so far; the frame exchange numbers
+// the frames it publishes the same way.
+uint32_t latency_trace_get_frames(void);
+
+// Main thread, after glfwSwapBuffers: frames up to `frame` are on screen.
+void latency_trace_present(uint32_t frame);
+
+void latency_trace_get_stats(latency_trace_stats_t *stats, bool reset);
+
+// Every presented event as CSV, in milliseconds after the GLFW callback.
+// Returns the number of rows written, -1 if the file could not be written.
+int latency_trace_write(const char *path);
+
+#endif // LATENCY_TRACE_H
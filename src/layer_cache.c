@@ -0,0 +1,397 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl.h"
+#include "lvgl_private.h"  // lv_draw_unit_t, lv_draw_task_t, lv_layer_t internals
+#include "layer_cache.h"
+#include "lru_cache.h"
+
+#define DRAW_UNIT_ID_LAYER_CACHE 22 // next to the gradient unit's id
+#define LAYER_CACHE_PREFERENCE 0    // the tasks of a cached layer all belong to this unit
+#define OPEN_LAYERS 16              // intermediate layers being drawn; one per chunk of a simple layer
+
+typedef enum {
+    LAYER_OPEN,     // tasks are still being added
+    LAYER_HIT,      // filled from the cache
+    LAYER_CAPTURE,  // rendered by SW, to be captured before it is blended
+} layer_state_t;
+
+// An intermediate layer of a cached widget while it is being drawn
+typedef struct {
+    lv_layer_t *layer;
+    lv_obj_t *obj;
+    lv_point_t origin;  // the widget's coordinates when it was drawn
+    uint64_t signature;
+    bool cacheable;
+    layer_state_t state;
+} open_layer_t;
+
+typedef struct {
+    lv_obj_t *obj;
+    lv_area_t area;     // relative to the widget
+    lv_color_format_t color_format;
+    uint64_t signature;
+} layer_key_t;
+
+typedef struct {
+    lru_slot_t slot;
+    layer_key_t key;
+    uint8_t *pixels;    // packed rows
+} layer_entry_t;
+
+static void release_entry(void *entry)
+{
+    free(((layer_entry_t *)entry)->pixels);
+}
+
+static lv_draw_unit_t *unit;
+static bool enabled;
+static open_layer_t open_layers[OPEN_LAYERS];
+static layer_entry_t entries[LAYER_CACHE_ENTRIES];
+static lru_cache_t cache = LRU_CACHE_INIT(entries, layer_entry_t, key, LAYER_CACHE_BYTES, release_entry);
+static layer_cache_stats_t stats;
+
+// FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ p[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+static uint64_t hash_area(uint64_t hash, const lv_area_t *area, const lv_point_t *origin)
+{
+    lv_area_t relative = *area;
+    lv_area_move(&relative, -origin->x, -origin->y);
+    return hash_bytes(hash, &relative, sizeof(relative));
+}
+
+// The descriptor after its base, which only points at the layer and the object
+static uint64_t hash_dsc(uint64_t hash, const void *dsc, size_t size)
+{
+    return hash_bytes(hash, (const uint8_t *)dsc + sizeof(lv_draw_dsc_base_t), size - sizeof(lv_draw_dsc_base_t));
+}
+
+static void move_point(lv_point_precise_t *p, const lv_point_t *origin)
+{
+    p->x -= origin->x;
+    p->y -= origin->y;
+}
+
+// Fold a task into the signature of its layer. Descriptors are copied byte-wise
+// (padding included, LVGL zeroes them) and absolute coordinates made relative
+// to the widget, so a layer drawn at another position hashes the same.
+static bool hash_task(open_layer_t *open, const lv_draw_task_t *t)
+{
+    const lv_point_t *origin = &open->origin;
+    uint64_t h = hash_bytes(open->signature, &t->type, sizeof(t->type));
+    h = hash_area(h, &t->area, origin);
+    h = hash_area(h, &t->clip_area, origin);
+
+    switch (t->type) {
+    case LV_DRAW_TASK_TYPE_FILL:
+        h = hash_dsc(h, t->draw_dsc, sizeof(lv_draw_fill_dsc_t));
+        break;
+    case LV_DRAW_TASK_TYPE_BORDER:
+        h = hash_dsc(h, t->draw_dsc, sizeof(lv_draw_border_dsc_t));
+        break;
+    case LV_DRAW_TASK_TYPE_BOX_SHADOW:
+        h = hash_dsc(h, t->draw_dsc, sizeof(lv_draw_box_shadow_dsc_t));
+        break;
+    case LV_DRAW_TASK_TYPE_LABEL: {
+        lv_draw_label_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        if (dsc.text)
+            h = hash_bytes(h, dsc.text, strlen(dsc.text));
+        dsc.text = NULL;  // the label may have reallocated the same text
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    case LV_DRAW_TASK_TYPE_IMAGE: {
+        lv_draw_image_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        lv_area_move(&dsc.image_area, -origin->x, -origin->y);
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    case LV_DRAW_TASK_TYPE_LINE: {
+        lv_draw_line_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        move_point(&dsc.p1, origin);
+        move_point(&dsc.p2, origin);
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    case LV_DRAW_TASK_TYPE_ARC: {
+        lv_draw_arc_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        dsc.center.x -= origin->x;
+        dsc.center.y -= origin->y;
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    case LV_DRAW_TASK_TYPE_TRIANGLE: {
+        lv_draw_triangle_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        for (int i = 0; i < 3; i++)
+            move_point(&dsc.p[i], origin);
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    case LV_DRAW_TASK_TYPE_MASK_RECTANGLE: {
+        lv_draw_mask_rect_dsc_t dsc;
+        memcpy(&dsc, t->draw_dsc, sizeof(dsc));
+        lv_area_move(&dsc.area, -origin->x, -origin->y);
+        h = hash_dsc(h, &dsc, sizeof(dsc));
+        break;
+    }
+    default:
+        // Layers, vector graphics and anything else refer to state that is not
+        // in the descriptor
+        return false;
+    }
+
+    open->signature = h;
+    return true;
+}
+
+static open_layer_t *find_open(const lv_layer_t *layer)
+{
+    for (int i = 0; i < OPEN_LAYERS; i++) {
+        if (layer && open_layers[i].layer == layer)
+            return &open_layers[i];
+    }
+    return NULL;
+}
+
+static open_layer_t *free_open(void)
+{
+    for (int i = 0; i < OPEN_LAYERS; i++) {
+        if (!open_layers[i].layer)
+            return &open_layers[i];
+    }
+    return NULL;
+}
+
+static void close_layer(open_layer_t *open)
+{
+    memset(open, 0, sizeof(*open));
+}
+
+static void make_key(layer_key_t *key, const open_layer_t *open)
+{
+    memset(key, 0, sizeof(*key));
+    key->obj = open->obj;
+    key->area = open->layer->buf_area;
+    lv_area_move(&key->area, -open->origin.x, -open->origin.y);
+    key->color_format = open->layer->color_format;
+    key->signature = open->signature;
+}
+
+// Drop the entries of obj, or of its `area` only if not NULL
+static void drop_entries(const lv_obj_t *obj, const lv_area_t *area)
+{
+    for (int i = 0; i < LAYER_CACHE_ENTRIES; i++) {
+        layer_entry_t *e = lru_cache_entry(&cache, i);
+        if (e && e->key.obj == obj && (!area || lv_area_is_equal(&e->key.area, area)))
+            lru_cache_drop(&cache, e);
+    }
+}
+
+static void copy_rows(uint8_t *dst, uint32_t dst_stride, const uint8_t *src, uint32_t src_stride, size_t width_bytes,
+                      int32_t rows)
+{
+    for (int32_t y = 0; y < rows; y++)
+        memcpy(dst + (size_t)y * dst_stride, src + (size_t)y * src_stride, width_bytes);
+}
+
+static size_t row_bytes(const lv_layer_t *layer)
+{
+    return (size_t)lv_area_get_width(&layer->buf_area) * lv_color_format_get_size(layer->color_format);
+}
+
+// Keep the rendered layer, replacing what was kept for the same area of the widget
+static void capture(const open_layer_t *open)
+{
+    const lv_layer_t *layer = open->layer;
+    if (!layer->draw_buf)
+        return;
+
+    layer_key_t key;
+    make_key(&key, open);
+    size_t row = row_bytes(layer);
+    int32_t rows = lv_area_get_height(&layer->buf_area);
+    size_t bytes = row * rows;
+    drop_entries(key.obj, &key.area);
+    layer_entry_t *e = lru_cache_insert(&cache, bytes, &stats.evictions);
+    if (!e || (e->pixels = malloc(bytes)) == NULL) {
+        if (e)
+            lru_cache_drop(&cache, e);
+        stats.uncached++;
+        return;
+    }
+
+    copy_rows(e->pixels, row, layer->draw_buf->data, layer->draw_buf->header.stride, row, rows);
+    e->key = key;
+}
+
+// A LAYER task blending the intermediate layer of a cached widget
+static bool is_open_layer_task(const lv_draw_task_t *t)
+{
+    return t->type == LV_DRAW_TASK_TYPE_LAYER && find_open(((const lv_draw_image_dsc_t *)t->draw_dsc)->src);
+}
+
+// Every task of the layer is known: fill it from the cache or let SW render it
+static int32_t resolve(open_layer_t *open)
+{
+    lv_layer_t *layer = open->layer;
+    layer_key_t key;
+    make_key(&key, open);
+    layer_entry_t *e = open->cacheable ? lru_cache_lookup(&cache, &key) : NULL;
+
+    if (e && lv_draw_layer_alloc_buf(layer)) {
+        copy_rows(layer->draw_buf->data, layer->draw_buf->header.stride, e->pixels, row_bytes(layer),
+                  row_bytes(layer), lv_area_get_height(&layer->buf_area));
+        for (lv_draw_task_t *t = layer->draw_task_head; t; t = t->next) {
+            if (t->preferred_draw_unit_id == DRAW_UNIT_ID_LAYER_CACHE)
+                t->state = LV_DRAW_TASK_STATE_READY;
+        }
+        open->state = LAYER_HIT;
+        stats.hits++;
+        stats.pixels += lv_area_get_size(&layer->buf_area);
+        lv_draw_dispatch_request();
+        return 1;
+    }
+
+    // The LAYER tasks of nested cached widgets stay with this unit
+    for (lv_draw_task_t *t = layer->draw_task_head; t; t = t->next) {
+        if (t->preferred_draw_unit_id == DRAW_UNIT_ID_LAYER_CACHE && !is_open_layer_task(t))
+            t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+    }
+    open->state = LAYER_CAPTURE;
+    if (open->cacheable)
+        stats.misses++;
+    else
+        stats.uncached++;
+    return LV_DRAW_UNIT_IDLE;
+}
+
+static int32_t evaluate_cb(lv_draw_unit_t *draw_unit, lv_draw_task_t *t)
+{
+    if (!enabled)
+        return 0;
+
+    // The LAYER task blending a cached widget's layer, to capture it first
+    if (is_open_layer_task(t)) {
+        open_layer_t *parent = find_open(((lv_draw_dsc_base_t *)t->draw_dsc)->layer);
+        if (parent)
+            parent->cacheable = false;
+        t->preference_score = LAYER_CACHE_PREFERENCE;
+        t->preferred_draw_unit_id = DRAW_UNIT_ID_LAYER_CACHE;
+        return 0;
+    }
+
+    open_layer_t *open = find_open(((lv_draw_dsc_base_t *)t->draw_dsc)->layer);
+    if (!open || open->state != LAYER_OPEN)
+        return 0;
+    if (open->cacheable && !hash_task(open, t))
+        open->cacheable = false;
+    t->preference_score = LAYER_CACHE_PREFERENCE;
+    t->preferred_draw_unit_id = DRAW_UNIT_ID_LAYER_CACHE;
+    return 0;
+}
+
+static int32_t dispatch_cb(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    int32_t taken = LV_DRAW_UNIT_IDLE;
+    open_layer_t *open = find_open(layer);
+    if (open && open->state == LAYER_OPEN && layer->all_tasks_added)
+        taken = resolve(open);
+
+    // Layers of cached widgets that are ready to be blended: capture what SW
+    // rendered, then leave the blend itself to SW
+    lv_draw_task_t *t = NULL;
+    while ((t = lv_draw_get_next_available_task(layer, t, DRAW_UNIT_ID_LAYER_CACHE)) != NULL) {
+        if (t->preferred_draw_unit_id != DRAW_UNIT_ID_LAYER_CACHE || t->type != LV_DRAW_TASK_TYPE_LAYER)
+            continue;
+
+        open_layer_t *drawn = find_open(((lv_draw_image_dsc_t *)t->draw_dsc)->src);
+        if (drawn) {
+            if (drawn->state == LAYER_CAPTURE && drawn->cacheable)
+                capture(drawn);
+            close_layer(drawn);
+        }
+        t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+    }
+    return taken;
+}
+
+static void draw_main_begin_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_current_target(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+
+    // Only the intermediate layer of the widget itself, not one of a parent
+    if (!enabled || !layer->parent || lv_obj_get_layer_type(obj) == LV_LAYER_TYPE_NONE || find_open(layer))
+        return;
+
+    open_layer_t *open = free_open();
+    if (!open) {
+        stats.uncached++;
+        return;
+    }
+    open->layer = layer;
+    open->obj = obj;
+    open->origin.x = obj->coords.x1;
+    open->origin.y = obj->coords.y1;
+    open->signature = 0xCBF29CE484222325ull;
+    open->cacheable = true;
+    open->state = LAYER_OPEN;
+}
+
+static void delete_cb(lv_event_t *e)
+{
+    layer_cache_invalidate(lv_event_get_current_target(e));
+}
+
+void layer_cache_init(void)
+{
+    if (!unit) {
+        unit = lv_draw_create_unit(sizeof(lv_draw_unit_t));
+        unit->evaluate_cb = evaluate_cb;
+        unit->dispatch_cb = dispatch_cb;
+    }
+    enabled = true;
+}
+
+void layer_cache_set_enabled(bool enable)
+{
+    enabled = enable && unit;
+    if (!enabled)
+        lru_cache_clear(&cache);
+}
+
+bool layer_cache_is_enabled(void)
+{
+    return enabled;
+}
+
+void layer_cache_enable(lv_obj_t *obj)
+{
+    // Before the widget draws anything into its layer
+    lv_obj_add_event_cb(obj, draw_main_begin_cb, LV_EVENT_DRAW_MAIN_BEGIN | LV_EVENT_PREPROCESS, NULL);
+    lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, NULL);
+}
+
+void layer_cache_invalidate(lv_obj_t *obj)
+{
+    drop_entries(obj, NULL);
+}
+
+void layer_cache_get_stats(layer_cache_stats_t *out, bool reset)
+{
+    *out = stats;
+    out->cached_bytes = (uint32_t)cache.cached_bytes;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,53 @@
+#ifndef LAYER_CACHE_H
+#define LAYER_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// Widgets with layered opacity, a blend mode or a transform are drawn into an
+// intermediate layer (in LV_DRAW_LAYER_SIMPLE_BUF_SIZE chunks for the simple
+// ones), which LVGL renders from scratch every time the widget is redrawn, even
+// when only its opacity or position animates.
+//
+// For widgets passed to layer_cache_enable, an LVGL draw unit takes every task
+// drawn into such a layer and folds it into a signature: task type, areas and
+// descriptor, relative to the widget, plus the text of labels. Once the layer is
+// complete the pixels are copied from the cache if a layer with the same
+// signature and area was kept, otherwise the tasks go back to the SW unit and
+// the rendered layer is captured before LVGL blends it. Opacity, blend mode and
+// transform are applied by that blend, so they never change the signature.
+//
+// Images redrawn in place (e.g. a canvas) keep their signature; call
+// layer_cache_invalidate after changing them. Layers that hold nested layers are
+// not cached.
+
+#define LAYER_CACHE_BYTES (8 * 1024 * 1024)
+#define LAYER_CACHE_ENTRIES 32
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;        // layers rendered and captured
+    uint32_t evictions;
+    uint32_t uncached;      // rendered but not kept: nested layers, unknown tasks, too large
+    uint32_t cached_bytes;
+    uint64_t pixels;        // copied from the cache
+} layer_cache_stats_t;
+
+// Call after lv_init().
+void layer_cache_init(void);
+
+// Disabling frees every cached layer; widgets then render as if never enabled.
+void layer_cache_set_enabled(bool enabled);
+bool layer_cache_is_enabled(void);
+
+// Cache the layers obj is drawn into. Its entries are dropped when it is deleted.
+void layer_cache_enable(lv_obj_t *obj);
+
+// Drop what is cached for obj, so it is rendered again.
+void layer_cache_invalidate(lv_obj_t *obj);
+
+// Call on the thread LVGL runs on, which updates the counters.
+void layer_cache_get_stats(layer_cache_stats_t *stats, bool reset);
+
+#endif // LAYER_CACHE_H
@@ -0,0 +1,102 @@
+#include <string.h>
+#include "lru_cache.h"
+
+static lru_slot_t *slot_at(const lru_cache_t *cache, int index)
+{
+    return (lru_slot_t *)((uint8_t *)cache->entries + (size_t)index * cache->entry_size);
+}
+
+static lru_slot_t *least_recently_used(const lru_cache_t *cache)
+{
+    lru_slot_t *lru = NULL;
+    for (int i = 0; i < cache->count; i++) {
+        lru_slot_t *slot = slot_at(cache, i);
+        if (slot->used && (!lru || slot->last_used < lru->last_used))
+            lru = slot;
+    }
+    return lru;
+}
+
+static lru_slot_t *free_slot(const lru_cache_t *cache)
+{
+    for (int i = 0; i < cache->count; i++) {
+        lru_slot_t *slot = slot_at(cache, i);
+        if (!slot->used)
+            return slot;
+    }
+    return NULL;
+}
+
+static void evict_to(lru_cache_t *cache, size_t bytes, uint32_t *evictions)
+{
+    while (cache->cached_bytes > bytes) {
+        lru_slot_t *victim = least_recently_used(cache);
+        if (!victim)
+            break;
+        lru_cache_drop(cache, victim);
+        (*evictions)++;
+    }
+}
+
+void *lru_cache_lookup(lru_cache_t *cache, const void *key)
+{
+    for (int i = 0; i < cache->count; i++) {
+        lru_slot_t *slot = slot_at(cache, i);
+        if (slot->used && memcmp((uint8_t *)slot + cache->key_offset, key, cache->key_size) == 0) {
+            slot->last_used = ++cache->clock;
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+void *lru_cache_insert(lru_cache_t *cache, size_t bytes, uint32_t *evictions)
+{
+    if (bytes > cache->budget)
+        return NULL;
+
+    // Make room for the new entry, in bytes and in slots
+    evict_to(cache, cache->budget - bytes, evictions);
+    lru_slot_t *slot = free_slot(cache);
+    if (!slot) {
+        lru_cache_drop(cache, least_recently_used(cache));
+        (*evictions)++;
+        slot = free_slot(cache);
+    }
+
+    memset(slot, 0, cache->entry_size);
+    slot->used = true;
+    slot->last_used = ++cache->clock;
+    slot->bytes = bytes;
+    cache->cached_bytes += bytes;
+    return slot;
+}
+
+void lru_cache_drop(lru_cache_t *cache, void *entry)
+{
+    lru_slot_t *slot = entry;
+    cache->release(entry);
+    cache->cached_bytes -= slot->bytes;
+    memset(entry, 0, cache->entry_size);
+}
+
+void lru_cache_clear(lru_cache_t *cache)
+{
+    for (int i = 0; i < cache->count; i++) {
+        lru_slot_t *slot = slot_at(cache, i);
+        if (slot->used)
+            lru_cache_drop(cache, slot);
+    }
+}
+
+void lru_cache_set_budget(lru_cache_t *cache, size_t bytes, uint32_t *evictions)
+{
+    cache->budget = bytes;
+    evict_to(cache, bytes, evictions);
+}
+
+void *lru_cache_entry(lru_cache_t *cache, int index)
+{
+    lru_slot_t *slot = slot_at(cache, index);
+    return slot->used ? slot : NULL;
+}
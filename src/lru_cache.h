@@ -0,0 +1,61 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The slot table behind the caching draw units: a fixed array of entries with a
+// byte budget, evicted least recently used first. Each entry type starts with
+// an lru_slot_t and holds a key compared with memcmp; what an entry owns is
+// freed through the cache's release callback. Not thread-safe; each cache
+// belongs to the thread LVGL runs on.
+
+typedef struct {
+    bool used;
+    uint32_t last_used;
+    size_t bytes;           // counted against the budget
+} lru_slot_t;
+
+typedef struct {
+    void *entries;
+    size_t entry_size;
+    int count;
+    size_t key_offset;
+    size_t key_size;
+    void (*release)(void *entry);
+    size_t budget;
+    size_t cached_bytes;
+    uint32_t clock;
+} lru_cache_t;
+
+// A static initializer for `array` of `type`, keyed by its `key_member`.
+#define LRU_CACHE_INIT(array, type, key_member, budget_bytes, release_cb) {                  \
+    .entries = (array),                                                                        \
+    .entry_size = sizeof(type),                                                                \
+    .count = (int)(sizeof(array) / sizeof(type)),                                              \
+    .key_offset = offsetof(type, key_member),                                                  \
+    .key_size = sizeof(((type *)0)->key_member),                                               \
+    .release = (release_cb),                                                                   \
+    .budget = (budget_bytes),                                                                  \
+}
+
+// The entry holding `key`, marked as just used; NULL on a miss.
+void *lru_cache_lookup(lru_cache_t *cache, const void *key);
+
+// A zeroed entry marked used with `bytes` counted, after evicting the least
+// recently used entries until a slot is free and the bytes fit. The caller
+// fills in the key and what the entry owns. NULL if `bytes` exceeds the budget.
+// Evicted entries are added to *evictions.
+void *lru_cache_insert(lru_cache_t *cache, size_t bytes, uint32_t *evictions);
+
+void lru_cache_drop(lru_cache_t *cache, void *entry);
+void lru_cache_clear(lru_cache_t *cache);
+
+// Change the budget, evicting down to it.
+void lru_cache_set_budget(lru_cache_t *cache, size_t bytes, uint32_t *evictions);
+
+// Entry `index`, NULL if that slot is unused; for walks over the whole cache.
+void *lru_cache_entry(lru_cache_t *cache, int index);
+
+#endif // LRU_CACHE_H
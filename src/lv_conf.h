@@ -105,8 +105,11 @@
  * - LV_OS_RTTHREAD
  * - LV_OS_WINDOWS
  * - LV_OS_MQX
- * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+ * - LV_OS_CUSTOM
+ * The build overrides this with LV_OS_PTHREAD when LVGL_GLFW_PARALLEL is ON. */
+#ifndef LV_USE_OS
+    #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -170,8 +173,11 @@
 
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
-     *  - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+     *  - > 1 means multiple threads will render the screen in parallel.
+     *  Set from LVGL_GLFW_DRAW_THREADS by the build when LVGL_GLFW_PARALLEL is ON. */
+    #ifndef LV_DRAW_SW_DRAW_UNIT_CNT
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -197,10 +203,14 @@
         #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
     #endif
 
-    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    /** Set to LV_DRAW_SW_ASM_CUSTOM by the build when LVGL_GLFW_SIMD is ON (the default
+     *  on x86-64): SSE2/AVX2 blend kernels picked at run time, see blend_x86.h. */
+    #ifndef LV_USE_DRAW_SW_ASM
+        #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    #endif
 
     #if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
-        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE ""
+        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE "blend_x86.h"
     #endif
 
     /** Enable drawing complex gradients in software: linear at an angle, radial or conical */
@@ -921,30 +931,34 @@
     #endif
 #endif /*LV_USE_SYSMON*/
 
-/** 1: Enable runtime performance profiler */
-#define LV_USE_PROFILER 0
+/** 1: Enable runtime performance profiler.
+ *  Set by the build when LVGL_GLFW_TRACE is ON (the default): the profiler points
+ *  go to a Chrome trace-event ring, see trace_profiler.h and --trace. */
+#ifndef LV_USE_PROFILER
+    #define LV_USE_PROFILER 0
+#endif
 #if LV_USE_PROFILER
     /** 1: Enable the built-in profiler */
-    #define LV_USE_PROFILER_BUILTIN 1
+    #define LV_USE_PROFILER_BUILTIN 0
     #if LV_USE_PROFILER_BUILTIN
         /** Default profiler trace buffer size */
         #define LV_PROFILER_BUILTIN_BUF_SIZE (16 * 1024)     /**< [bytes] */
     #endif
 
     /** Header to include for profiler */
-    #define LV_PROFILER_INCLUDE "lvgl/src/misc/lv_profiler_builtin.h"
+    #define LV_PROFILER_INCLUDE "trace_profiler.h"
 
     /** Profiler start point function */
-    #define LV_PROFILER_BEGIN    LV_PROFILER_BUILTIN_BEGIN
+    #define LV_PROFILER_BEGIN    TRACE_PROFILER_BEGIN
 
     /** Profiler end point function */
-    #define LV_PROFILER_END      LV_PROFILER_BUILTIN_END
+    #define LV_PROFILER_END      TRACE_PROFILER_END
 
     /** Profiler start point function with custom tag */
-    #define LV_PROFILER_BEGIN_TAG LV_PROFILER_BUILTIN_BEGIN_TAG
+    #define LV_PROFILER_BEGIN_TAG TRACE_PROFILER_BEGIN_TAG
 
     /** Profiler end point function with custom tag */
-    #define LV_PROFILER_END_TAG   LV_PROFILER_BUILTIN_END_TAG
+    #define LV_PROFILER_END_TAG   TRACE_PROFILER_END_TAG
 
     /*Enable layout profiler*/
     #define LV_PROFILER_LAYOUT 1
@@ -1,20 +1,147 @@
 #define GL_SILENCE_DEPRECATION
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <GLFW/glfw3.h>
 #include "lvgl.h"
+#include "gl_ext.h"
+#include "gl_upload.h"
+#include "dirty_rects.h"
+#include "presenter.h"
+#include "gl_draw.h"
+#include "grad_draw.h"
+#include "layer_cache.h"
+#include "mask_draw.h"
+#include "event_queue.h"
+#include "glfw_input.h"
+#include "latency_trace.h"
+#include "input_replay.h"
+#include "frame_pacer.h"
+#include "frame_exchange.h"
+#include "render_thread.h"
+#include "buffer_pool.h"
+#include "compositor.h"
+#include "demo_scene.h"
+#include "offscreen.h"
+#include "gl_trace.h"
+#include "hud.h"
+#include "percentile.h"
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
+#include "blend_x86.h"
+#include "blend_bench.h"
+#endif
+#if LV_USE_PROFILER
+#include "trace_profiler.h"
+#endif
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
+#define STATS_INTERVAL 5.0  // seconds between --stats reports
+#define FRAME_COUNTER_PERIOD 1000  // [ms] label refresh period in the event-driven loop
+#define OFFSCREEN_FRAMES 300  // per --offscreen phase
+#define TRACE_POLL_MS 100  // longest wait for events while tracing, so a SIGUSR1 dump is written promptly
+#define POOL_TRIM_DELAY 1000  // [ms] after the last resize, free the buffers the drag left pooled
 
 static GLuint texture;
+static int32_t texture_width;  // the frame in the texture; the texture itself can be larger
+static int32_t texture_height;
+static int32_t texture_capacity_width;
+static int32_t texture_capacity_height;
+static GLint max_texture_size;
 static lv_draw_buf_t draw_buf;
 static lv_color32_t *buf;
+static size_t buf_capacity;
+static bool buf_mapped;  // buf points into GPU-visible memory owned by gl_upload
+static lv_color32_t *bands[2];  // partial render mode: LVGL renders one band of the screen at a time
+static size_t band_capacity[2];
+static uint32_t band_size;
+static lv_timer_t *pool_trim_timer;
+
+// Window size changes are applied once per loop iteration, with the latest size
+static struct {
+    bool pending;
+    int32_t width;
+    int32_t height;
+    uint32_t requests;      // size callbacks since the last report
+    uint32_t applied;
+    uint32_t texture_reallocs;
+} resize;
 static lv_display_t *disp;
 static lv_obj_t *resolution_label;
 static lv_obj_t *frame_counter_label;
 static lv_obj_t *selectable_label;
-static uint32_t frame_count = 0;
+static compositor_layer_t *spin_layer;
+static lv_obj_t *spin_obj;
+static atomic_uint frame_count;  // presented on the main thread, shown by the LVGL thread in threaded mode
+static bool needs_present = true;  // the texture or the window contents changed since the last swap
+static uint32_t frames_skipped = 0;
+static uint32_t texture_frame;  // threaded mode: sequence of the exchanged frame in the texture
+
+typedef enum {
+    LOOP_EVENT,     // sleep until the next LVGL timer is due or GLFW has input
+    LOOP_POLL,      // spin continuously, redrawing every iteration
+    LOOP_THREADED,  // LVGL on its own thread, the main thread only uploads and presents
+} loop_mode_t;
+
+// Threaded mode: the main thread queues resizes for the LVGL thread (input goes
+// through glfw_input), which hands finished frames back through frame_exchange
+static event_queue_t input_queue;
+static dirty_rects_t render_damage;  // LVGL thread: areas flushed for the frame in progress
+
+static struct {
+    int32_t width;
+    int32_t height;
+    loop_mode_t loop_mode;
+    gl_upload_mode_t upload_mode;
+    bool no_coalesce;
+    uint32_t coalesce_overhead;
+    presenter_config_t presenter;
+    bool gl_draw;
+    bool draw_compare;
+    bool grad_draw;
+    bool layer_cache;
+    bool mask_draw;
+    size_t mask_budget;
+    bool fade;          // a translucent panel sliding back and forth, drawn from the layer cache
+    bool composite;     // the gradient background in a retained layer under the main display
+    bool spin;          // plus a layer turned by the presenter every frame
+    presenter_rotation_t rotation;
+    bool partial;
+    int bands;          // partial mode: a band is 1/bands of the screen height
+    int band_buffers;   // partial mode: 1, or 2 so LVGL can render into one while the other is flushed
+    int bench_frames;
+    const char * simd;      // NULL: the best level the CPU supports
+    int blend_bench;
+    bool stats;
+    bool latency;
+    const char * latency_file;  // NULL: report only
+    frame_pacer_vsync_t vsync;
+    bool jit;           // event loop: start frames just in time for the vblank
+    int offscreen_frames;   // present into an FBO with no window shown, time it and exit
+    const char * record_file;   // input consumed by LVGL, for --replay
+    const char * replay_file;
+    const char * frame_trace_file;  // replay: per-frame times as CSV
+    const char * trace_file;    // Chrome trace-event JSON, NULL: not tracing
+    bool hud;           // performance overlay drawn by the presenter instead of the frame counter label
+} options = {
+    .width = WINDOW_WIDTH,
+    .height = WINDOW_HEIGHT,
+    .loop_mode = LOOP_EVENT,
+    .upload_mode = GL_UPLOAD_PBO,
+    .coalesce_overhead = DIRTY_RECTS_DEFAULT_OVERHEAD_PX,
+    .bands = 10,
+    .band_buffers = 2,
+    .grad_draw = true,
+    .layer_cache = true,
+    .mask_draw = true,
+    .mask_budget = MASK_DRAW_DEFAULT_BUDGET,
+    .vsync = FRAME_PACER_VSYNC_ON,
+    .presenter = {
+        .filter = PRESENTER_FILTER_LINEAR,
+        .gamma = 1.0f,
+    },
+};
 
 static int selection_start = LV_LABEL_TEXT_SELECTION_OFF;
 static int selection_end = LV_LABEL_TEXT_SELECTION_OFF;
@@ -22,37 +149,63 @@ static int selection_end = LV_LABEL_TEXT_SELECTION_OFF;
 static void my_disp_flush(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
 {
     int32_t width = lv_display_get_horizontal_resolution(disp);
-    int32_t height = lv_display_get_vertical_resolution(disp);
-
-    // Calculate the start position of the updated area in px_map
-    int32_t stride = width * sizeof(lv_color32_t);  // Bytes per row
-    uint8_t *start_pos = px_map + (area->y1 * stride) + (area->x1 * sizeof(lv_color32_t));
 
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);  // Set the row length to the full width of the texture
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Ensure 1-byte alignment
+    LV_PROFILER_BEGIN;
+    if (latency_trace_is_enabled())
+        latency_trace_flush(area, lv_display_flush_is_last(disp));
 
-    glTexSubImage2D(GL_TEXTURE_2D, 0, area->x1, area->y1,
-                    lv_area_get_width(area), lv_area_get_height(area),
-                    GL_RGBA, GL_UNSIGNED_BYTE, start_pos);
+    if (options.loop_mode == LOOP_THREADED) {
+        // Runs on the LVGL thread: hand the frame over and let the main thread upload it
+        dirty_rects_add(&render_damage, area);
+        if (lv_display_flush_is_last(disp)) {
+            frame_exchange_publish(px_map, width, lv_display_get_vertical_resolution(disp),
+                                   width * sizeof(lv_color32_t), &render_damage);
+            dirty_rects_reset(&render_damage);
+            glfwPostEmptyEvent();
+        }
+        lv_display_flush_ready(disp);
+        LV_PROFILER_END;
+        return;
+    }
 
-    // Reset the row length
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    if (options.partial) {
+        // px_map holds just this band and LVGL renders another band into it next, so upload it now
+        int32_t stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), lv_display_get_color_format(disp));
+        gl_upload_band(area, px_map, stride);
+    }
+    else {
+        // px_map is the whole frame in direct mode, so rows are a full screen width apart
+        gl_upload_area(area, px_map, width * sizeof(lv_color32_t));
+    }
+    if (lv_display_flush_is_last(disp))
+        gl_upload_frame_done();
+    needs_present = true;
 
     lv_display_flush_ready(disp);
+    LV_PROFILER_END;
+}
+
+static void render_start_cb(lv_event_t * e)
+{
+    // LVGL is about to draw into buf again, which a persistent-mode upload may still be reading
+    gl_upload_begin_frame();
+}
+
+// LVGL's resolution for a window size: the presenter turns the frame by --rotate
+static void frame_size(int window_width, int window_height, int32_t * width, int32_t * height)
+{
+    bool transposed = options.rotation == PRESENTER_ROTATION_90 || options.rotation == PRESENTER_ROTATION_270;
+    *width = transposed ? window_height : window_width;
+    *height = transposed ? window_width : window_height;
 }
 
-static void my_mouse_read(lv_indev_t * indev, lv_indev_data_t * data)
+static uint32_t tick_get_cb(void)
 {
-    GLFWwindow* window = (GLFWwindow*)lv_indev_get_user_data(indev);
-    
-    double x, y;
-    glfwGetCursorPos(window, &x, &y);
+    if (input_replay_is_active())
+        return input_replay_tick();
 
-    data->point.x = (int16_t)x;
-    data->point.y = (int16_t)y;
-    data->state = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS ? 
-                  LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    // glfwGetTime is monotonic; go through 64 bits so the millisecond count wraps instead of overflowing
+    return (uint32_t)(uint64_t)(glfwGetTime() * 1000.0);
 }
 
 static void update_resolution_text(int width, int height)
@@ -64,33 +217,812 @@ static void update_resolution_text(int width, int height)
 
 static void update_frame_counter()
 {
+    if (!frame_counter_label)
+        return;  // --hud counts frames without touching LVGL
+
     char buf[32];
-    snprintf(buf, sizeof(buf), "Frames: %u", frame_count++);
+    snprintf(buf, sizeof(buf), "Frames: %u", frame_count);
     lv_label_set_text(frame_counter_label, buf);
 }
 
-static void window_resize_callback(GLFWwindow* window, int width, int height)
+static void frame_counter_timer_cb(lv_timer_t * timer)
 {
-    // Update OpenGL viewport
-    glViewport(0, 0, width, height);
+    update_frame_counter();
+}
 
-    // Update LVGL display resolution
-    lv_display_set_resolution(disp, width, height);
+static void window_refresh_callback(GLFWwindow* window)
+{
+    // The window system lost our contents (exposed, restored, ...)
+    needs_present = true;
+}
 
-    // Resize the draw buffer
-    lv_draw_buf_destroy(&draw_buf);
-    buf = realloc(buf, width * height * sizeof(lv_color32_t));
-    lv_draw_buf_init(&draw_buf, width, height, LV_COLOR_FORMAT_NATIVE, 
+static void wait_for_events(GLFWwindow* window, uint32_t idle_ms)
+{
+    // While the button or a key is held LVGL needs periodic reads for long press and repeat
+    // (the LVGL thread takes care of that itself in threaded mode)
+    if (options.loop_mode != LOOP_THREADED && glfw_input_is_held() && idle_ms > LV_DEF_REFR_PERIOD)
+        idle_ms = LV_DEF_REFR_PERIOD;
+
+    if (idle_ms == LV_NO_TIMER_READY)
+        glfwWaitEvents();
+    else if (idle_ms > 0)
+        glfwWaitEventsTimeout(idle_ms / 1000.0);
+    else
+        glfwPollEvents();
+}
+
+static void print_loop_stats(const char * label, uint32_t * iterations)
+{
+    static uint32_t last_frame_count;
+
+    static const char * const names[] = { "event", "poll", "thread" };
+    uint32_t frames = frame_count;
+
+    printf("[%s] loop (%s): %u iterations, %u frames presented, %u skipped\n", label,
+           names[options.loop_mode], *iterations, frames - last_frame_count, frames_skipped);
+    *iterations = 0;
+    last_frame_count = frames;
+    frames_skipped = 0;
+}
+
+static void print_resize_stats(const char * label)
+{
+    printf("[%s] resize: %u size changes, %u applied, %u texture reallocations", label,
+           resize.requests, resize.applied, resize.texture_reallocs);
+    resize.requests = resize.applied = resize.texture_reallocs = 0;
+
+    // The pool belongs to the LVGL thread in threaded mode
+    if (options.loop_mode != LOOP_THREADED) {
+        buffer_pool_stats_t st;
+        buffer_pool_get_stats(&st, true);
+        printf(", buffers: %u new, %u reused, %.1f KiB pooled", st.allocations, st.reuses, st.cached_bytes / 1024.0);
+    }
+    printf("\n");
+}
+
+static void print_exchange_stats(const char * label)
+{
+    frame_exchange_stats_t st;
+    frame_exchange_get_stats(&st, true);
+
+    printf("[%s] exchange: %u frames rendered, %u uploaded, %u replaced before upload\n",
+           label, st.published, st.acquired, st.replaced);
+}
+
+static void print_upload_stats(const char * label)
+{
+    gl_upload_stats_t st;
+    gl_upload_get_stats(&st, true);
+
+    printf("[%s] upload (%s): %u frames, areas/frame avg %.1f max %u, uploads/frame avg %.1f max %u, "
+           "%.1f KiB, flush->upload avg %.3f ms max %.3f ms",
+           label, gl_upload_mode_name(gl_upload_get_mode()), st.frames,
+           st.frames ? (double)st.areas / st.frames : 0.0, st.areas_max,
+           st.frames ? (double)st.uploads / st.frames : 0.0, st.uploads_max,
+           st.bytes / 1024.0, st.frames ? st.cpu_ms / st.frames : 0.0, st.cpu_ms_max);
+    if (gl_upload_get_mode() == GL_UPLOAD_PBO) {
+        printf(", transfer done avg %.3f ms, %u stalls (%.3f ms)",
+               st.gpu_samples ? st.gpu_ms / st.gpu_samples : 0.0, st.stalls, st.stall_ms);
+    }
+    printf("\n");
+}
+
+static void print_draw_stats(const char * label)
+{
+    gl_draw_stats_t st;
+    gl_draw_get_stats(&st, true);
+
+    printf("[%s] gl draw: %u fills, %u borders, %u images, %u left to SW, %.1f Kpx read back, %.3f ms\n",
+           label, st.fills, st.borders, st.images, st.handed_back, st.pixels / 1000.0, st.ms);
+}
+
+static void print_compositor_stats(const char * label)
+{
+    compositor_stats_t st;
+    compositor_get_stats(&st, true);
+
+    printf("[%s] layers: %d, %u layer frames, %u areas uploaded, %.1f KiB\n",
+           label, compositor_layer_count(), st.renders, st.uploads, st.bytes / 1024.0);
+}
+
+static void print_grad_stats(const char * label)
+{
+    grad_draw_stats_t st;
+    grad_draw_get_stats(&st, true);
+
+    printf("[%s] gradients: %u fills, %u hits, %u misses, %u evictions, %u span-rendered, %.1f KiB cached, "
+           "%.1f Kpx, %.3f ms\n",
+           label, st.fills, st.hits, st.misses, st.evictions, st.uncached, st.cached_bytes / 1024.0,
+           st.pixels / 1000.0, st.ms);
+}
+
+static void print_layer_cache_stats(const char * label)
+{
+    layer_cache_stats_t st;
+    layer_cache_get_stats(&st, true);
+
+    printf("[%s] layer cache: %u hits, %u misses, %u evictions, %u uncached, %.1f KiB cached, %.1f Kpx copied\n",
+           label, st.hits, st.misses, st.evictions, st.uncached, st.cached_bytes / 1024.0, st.pixels / 1000.0);
+}
+
+static void print_mask_stats(const char * label)
+{
+    mask_draw_stats_t st;
+    mask_draw_get_stats(&st, true);
+
+    uint32_t lookups = st.hits + st.misses + st.uncached;
+    printf("[%s] masks: %u shadows, %u rounded fills, %u hits (%.1f%%), %u misses, %u evictions, %u uncached, "
+           "%.1f of %.1f KiB cached, %.1f Kpx, %.3f ms\n",
+           label, st.shadows, st.fills, st.hits, lookups ? 100.0 * st.hits / lookups : 0.0, st.misses, st.evictions,
+           st.uncached, st.cached_bytes / 1024.0, st.budget / 1024.0, st.pixels / 1000.0, st.ms);
+}
+
+static void print_pacer_stats(const char * label)
+{
+    frame_pacer_stats_t st;
+    frame_pacer_get_stats(&st, true);
+
+    printf("[%s] pacing (vsync %s%s): %u frames, %u missed deadlines, interval avg %.2f min %.2f max %.2f ms "
+           "at %.2f Hz, frame cost avg %.3f max %.3f ms, %.1f ms waited for slots\n",
+           label, frame_pacer_vsync_name(frame_pacer_get_vsync()), options.jit ? ", jit" : "", st.frames, st.missed,
+           st.interval_avg, st.interval_min, st.interval_max, st.refresh_hz, st.cost_avg, st.cost_max, st.jit_wait_ms);
+}
+
+static void print_input_stats(const char * label)
+{
+    glfw_input_stats_t st;
+    glfw_input_get_stats(&st, true);
+
+    printf("[%s] input: %u events, %u motion coalesced, %u indev reads, %u dropped\n",
+           label, st.events, st.coalesced, st.reads, st.dropped);
+}
+
+static void print_latency_stats(const char * label)
+{
+    latency_trace_stats_t st;
+    latency_trace_get_stats(&st, true);
+
+    printf("[%s] latency: %u events, %u presented, %u no redraw, %u dropped, input->swap p50 %.2f p95 %.2f "
+           "p99 %.2f max %.2f ms (median read %.2f, invalidate %.2f, flush %.2f ms)\n",
+           label, st.traced, st.presented, st.no_redraw, st.overflow, st.p50, st.p95, st.p99, st.max,
+           st.read_p50, st.invalidate_p50, st.flush_p50);
+}
+
+static void print_stats(const char * label, uint32_t * loop_iterations)
+{
+    if (options.stats) {
+        print_loop_stats(label, loop_iterations);
+        print_upload_stats(label);
+        print_resize_stats(label);
+        print_input_stats(label);
+        print_pacer_stats(label);
+        if (options.loop_mode == LOOP_THREADED)
+            print_exchange_stats(label);
+        if (gl_draw_is_enabled())
+            print_draw_stats(label);
+        // The SW draw units count on the LVGL thread in threaded mode
+        if (grad_draw_is_enabled() && options.loop_mode != LOOP_THREADED)
+            print_grad_stats(label);
+        if (mask_draw_is_enabled() && options.loop_mode != LOOP_THREADED)
+            print_mask_stats(label);
+        if (layer_cache_is_enabled() && options.loop_mode != LOOP_THREADED)
+            print_layer_cache_stats(label);
+        if (compositor_layer_count())
+            print_compositor_stats(label);
+    }
+    if (options.latency)
+        print_latency_stats(label);
+}
+
+static double render_screen(void)
+{
+    double start = glfwGetTime();
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+    return (glfwGetTime() - start) * 1000.0;
+}
+
+// One untimed pass first, so font caches and shader warm-up are not counted
+static double render_screen_with(bool gl, bool grad, bool mask)
+{
+    gl_draw_set_enabled(gl);
+    grad_draw_set_enabled(grad);
+    mask_draw_set_enabled(mask);
+    render_screen();
+    return render_screen();
+}
+
+static void print_difference(const char * unit, const lv_color32_t * sw_frame, double sw_ms, double ms)
+{
+    int32_t width = lv_display_get_horizontal_resolution(disp);
+    int32_t height = lv_display_get_vertical_resolution(disp);
+    size_t pixels = (size_t)width * height;
+    size_t differing = 0;
+    int max_diff = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        int d = LV_MAX(abs(sw_frame[i].red - buf[i].red),
+                       LV_MAX(abs(sw_frame[i].green - buf[i].green), abs(sw_frame[i].blue - buf[i].blue)));
+        if (d) {
+            differing++;
+            if (d > max_diff)
+                max_diff = d;
+        }
+    }
+    printf("[compare] %dx%d: SW %.3f ms, %s %.3f ms, %zu pixels differ (%.2f%%), max channel difference %d\n",
+           width, height, sw_ms, unit, ms, differing, 100.0 * differing / pixels, max_diff);
+}
+
+// Render the current screen with plain SW, then with each of the GL draw unit,
+// the gradient unit and the mask unit on its own, and report how they differ, in
+// time and in pixels. The layer cache stays off throughout, so every pass draws.
+static void compare_draw_units(bool gl_ready)
+{
+    size_t pixels = (size_t)lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp);
+    lv_color32_t * sw_frame = malloc(pixels * sizeof(lv_color32_t));
+    bool gl_was_enabled = gl_draw_is_enabled();
+    bool grad_was_enabled = grad_draw_is_enabled();
+    bool mask_was_enabled = mask_draw_is_enabled();
+    bool layer_cache_was_enabled = layer_cache_is_enabled();
+    layer_cache_set_enabled(false);
+
+    double sw_ms = render_screen_with(false, false, false);
+    memcpy(sw_frame, buf, pixels * sizeof(lv_color32_t));
+
+    if (gl_ready) {
+        print_difference("GL", sw_frame, sw_ms, render_screen_with(true, false, false));
+        print_draw_stats("compare");
+    }
+    print_difference("gradients", sw_frame, sw_ms, render_screen_with(false, true, false));
+    print_grad_stats("compare");
+    print_difference("masks", sw_frame, sw_ms, render_screen_with(false, false, true));
+    print_mask_stats("compare");
+
+    free(sw_frame);
+    gl_draw_set_enabled(gl_was_enabled);
+    grad_draw_set_enabled(grad_was_enabled);
+    mask_draw_set_enabled(mask_was_enabled);
+    layer_cache_set_enabled(layer_cache_was_enabled);
+}
+
+static size_t draw_buffer_bytes(void)
+{
+    if (options.partial)
+        return (size_t)band_size * options.band_buffers;
+    return (size_t)lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp) *
+           sizeof(lv_color32_t);
+}
+
+// Time full-screen redraws, e.g. to compare builds with different draw thread counts
+static void run_benchmark(int frames)
+{
+    double total = 0.0, min = 0.0, max = 0.0;
+
+    render_screen();  // warm up caches
+    for (int i = 0; i < frames; i++) {
+        double ms = render_screen();
+        total += ms;
+        if (i == 0 || ms < min)
+            min = ms;
+        if (ms > max)
+            max = ms;
+    }
+    printf("[bench] %d SW draw unit(s)%s, %s render (%.1f KiB draw buffers): "
+           "%d full-screen frames, avg %.3f ms, min %.3f ms, max %.3f ms\n",
+           LV_DRAW_SW_DRAW_UNIT_CNT, gl_draw_is_enabled() ? " + GL" : "", options.partial ? "partial" : "direct",
+           draw_buffer_bytes() / 1024.0, frames, total / frames, min, max);
+}
+
+typedef struct {
+    double upload_ms;   // submitted by the flush, plus waiting until the texture holds it
+    double present_ms;  // presenter_draw until the GPU finished it
+    uint64_t bytes;     // uploaded
+} offscreen_frame_t;
+
+// One frame through the real flush and presenter, each stage finished before
+// the next starts so they are timed apart
+static void offscreen_frame(bool full, offscreen_frame_t * frame)
+{
+    if (full)
+        lv_obj_invalidate(lv_screen_active());
+    else
+        update_frame_counter();
+
+    lv_refr_now(disp);
+    double rendered = glfwGetTime();
+    glFinish();
+    double uploaded = glfwGetTime();
+
+    gl_upload_stats_t st;
+    gl_upload_get_stats(&st, true);
+    frame->upload_ms = st.cpu_ms + (uploaded - rendered) * 1000.0;
+    frame->bytes = st.bytes;
+
+    offscreen_bind();
+    presenter_draw();
+    glFinish();
+    frame->present_ms = (glfwGetTime() - uploaded) * 1000.0;
+    frame_count++;
+    needs_present = false;
+}
+
+static void offscreen_report(const char * phase, offscreen_frame_t * frames, int count)
+{
+    double * upload = malloc(count * sizeof(double));
+    double * present = malloc(count * sizeof(double));
+    if (!upload || !present) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    uint64_t bytes = 0;
+    double upload_total = 0.0, present_total = 0.0;
+    for (int i = 0; i < count; i++) {
+        upload[i] = frames[i].upload_ms;
+        present[i] = frames[i].present_ms;
+        upload_total += upload[i];
+        present_total += present[i];
+        bytes += frames[i].bytes;
+    }
+    percentile_sort(upload, count);
+    percentile_sort(present, count);
+    printf("{\"phase\": \"%s\", \"frames\": %d, \"upload_bytes_per_frame\": %llu, "
+           "\"upload_avg_ms\": %.4f, \"upload_p50_ms\": %.4f, \"upload_p95_ms\": %.4f, \"upload_max_ms\": %.4f, "
+           "\"present_avg_ms\": %.4f, \"present_p50_ms\": %.4f, \"present_p95_ms\": %.4f, \"present_max_ms\": %.4f}\n",
+           phase, count, (unsigned long long)(bytes / count),
+           upload_total / count, percentile(upload, count, 0.50), percentile(upload, count, 0.95), upload[count - 1],
+           present_total / count, percentile(present, count, 0.50), percentile(present, count, 0.95),
+           present[count - 1]);
+    fflush(stdout);
+    free(upload);
+    free(present);
+}
+
+// Time the texture upload and the presenter per frame against a framebuffer
+// object: full-screen redraws first, then the small updates of the frame
+// counter. Output is JSON lines, like lvgl_glfw_bench's.
+static void run_offscreen(int frames)
+{
+    int32_t width, height;
+    glfwGetFramebufferSize(glfwGetCurrentContext(), &width, &height);
+    if (!offscreen_init(width, height)) {
+        fprintf(stderr, "No framebuffer objects on OpenGL %d.%d, cannot present offscreen\n", gl_ext.major, gl_ext.minor);
+        return;
+    }
+    offscreen_frame_t * samples = malloc(frames * sizeof(offscreen_frame_t));
+    if (!samples) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    printf("{\"offscreen\": \"%s\", \"gl\": \"%s\", \"width\": %d, \"height\": %d, \"upload\": \"%s\", "
+           "\"presenter\": \"%s\", \"render\": \"%s\", \"frames\": %d}\n",
+           (const char *)glGetString(GL_RENDERER), (const char *)glGetString(GL_VERSION), width, height,
+           gl_upload_mode_name(gl_upload_get_mode()), presenter_uses_shader() ? "shader" : "fixed-function",
+           options.partial ? "partial" : "direct", frames);
+
+    static const char * const phases[] = { "full", "label" };
+    offscreen_frame_t warmup;
+    for (int phase = 0; phase < 2; phase++) {
+        offscreen_frame(phase == 0, &warmup);  // shader and texture warm-up
+        for (int i = 0; i < frames; i++)
+            offscreen_frame(phase == 0, &samples[i]);
+        offscreen_report(phases[phase], samples, frames);
+    }
+
+    // Ends on a known frame counter, so runs of the same build present the same pixels
+    printf("{\"checksum\": \"%08x\"}\n", offscreen_checksum());
+    free(samples);
+    offscreen_deinit();
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Run the recorded session frame by frame on the replay's clock, as fast as the
+// frames render, then report their times
+static void run_replay(GLFWwindow * window)
+{
+    glfw_input_set_live(false);
+
+    while (!glfwWindowShouldClose(window) && input_replay_next_frame(INPUT_REPLAY_STEP_MS, glfw_input_inject)) {
+        double start = glfwGetTime();
+        glfw_input_process();
+        lv_timer_handler();
+        hud_sample_heap();
+        if (compositor_take_damage())
+            needs_present = true;
+        double rendered = glfwGetTime();
+
+        bool presented = needs_present;
+        if (presented) {
+            presenter_draw();
+            frame_pacer_swap();
+            hud_frame_presented();
+            frame_count++;
+            needs_present = false;
+        }
+        input_replay_frame_done((rendered - start) * 1000.0, (glfwGetTime() - rendered) * 1000.0, presented);
+
+        // Keeps the window responsive; what it reports is ignored
+        glfwPollEvents();
+    }
+
+    input_replay_stats_t st;
+    input_replay_get_stats(&st);
+    printf("[replay] %u events over %u frames (%u presented), frame p50 %.3f p95 %.3f p99 %.3f max %.3f ms "
+           "(frame %u, tick %u ms)\n",
+           st.events, st.frames, st.presented, st.p50, st.p95, st.p99, st.max, st.max_frame, st.max_tick);
+    if (options.frame_trace_file) {
+        int rows = input_replay_write_trace(options.frame_trace_file);
+        if (rows < 0)
+            fprintf(stderr, "Could not write %s\n", options.frame_trace_file);
+        else
+            printf("[replay] %d frames written to %s\n", rows, options.frame_trace_file);
+    }
+}
+
+static void parse_options(int argc, char ** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--loop=event") == 0) {
+            options.loop_mode = LOOP_EVENT;
+        }
+        else if (strcmp(argv[i], "--loop=poll") == 0) {
+            options.loop_mode = LOOP_POLL;
+        }
+        else if (strcmp(argv[i], "--loop=thread") == 0) {
+            options.loop_mode = LOOP_THREADED;
+        }
+        else if (strncmp(argv[i], "--upload=", 9) == 0) {
+            if (!gl_upload_parse_mode(argv[i] + 9, &options.upload_mode)) {
+                fprintf(stderr, "Unknown upload mode: %s\n", argv[i] + 9);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--no-pbo") == 0) {
+            options.upload_mode = GL_UPLOAD_DIRECT;
+        }
+        else if (strcmp(argv[i], "--no-coalesce") == 0) {
+            options.no_coalesce = true;
+        }
+        else if (strncmp(argv[i], "--coalesce-overhead=", 20) == 0) {
+            options.coalesce_overhead = (uint32_t)strtoul(argv[i] + 20, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--legacy-gl") == 0) {
+            options.presenter.legacy = true;
+        }
+        else if (strcmp(argv[i], "--filter=nearest") == 0) {
+            options.presenter.filter = PRESENTER_FILTER_NEAREST;
+        }
+        else if (strcmp(argv[i], "--filter=linear") == 0) {
+            options.presenter.filter = PRESENTER_FILTER_LINEAR;
+        }
+        else if (strncmp(argv[i], "--gamma=", 8) == 0) {
+            options.presenter.gamma = strtof(argv[i] + 8, NULL);
+        }
+        else if (strcmp(argv[i], "--draw=sw") == 0) {
+            options.gl_draw = false;
+        }
+        else if (strcmp(argv[i], "--draw=gl") == 0) {
+            options.gl_draw = true;
+        }
+        else if (strcmp(argv[i], "--draw-compare") == 0) {
+            options.draw_compare = true;
+        }
+        else if (strcmp(argv[i], "--composite") == 0) {
+            options.composite = true;
+        }
+        else if (strcmp(argv[i], "--spin") == 0) {
+            options.composite = true;
+            options.spin = true;
+        }
+        else if (strcmp(argv[i], "--rotate=0") == 0) {
+            options.rotation = PRESENTER_ROTATION_0;
+        }
+        else if (strcmp(argv[i], "--rotate=90") == 0) {
+            options.rotation = PRESENTER_ROTATION_90;
+        }
+        else if (strcmp(argv[i], "--rotate=180") == 0) {
+            options.rotation = PRESENTER_ROTATION_180;
+        }
+        else if (strcmp(argv[i], "--rotate=270") == 0) {
+            options.rotation = PRESENTER_ROTATION_270;
+        }
+        else if (strcmp(argv[i], "--grad-cache=on") == 0) {
+            options.grad_draw = true;
+        }
+        else if (strcmp(argv[i], "--grad-cache=off") == 0) {
+            options.grad_draw = false;
+        }
+        else if (strcmp(argv[i], "--layer-cache=on") == 0) {
+            options.layer_cache = true;
+        }
+        else if (strcmp(argv[i], "--layer-cache=off") == 0) {
+            options.layer_cache = false;
+        }
+        else if (strcmp(argv[i], "--mask-cache=on") == 0) {
+            options.mask_draw = true;
+        }
+        else if (strcmp(argv[i], "--mask-cache=off") == 0) {
+            options.mask_draw = false;
+        }
+        else if (strncmp(argv[i], "--mask-budget=", 14) == 0) {
+            options.mask_budget = (size_t)strtoul(argv[i] + 14, NULL, 10) * 1024;
+        }
+        else if (strcmp(argv[i], "--fade") == 0) {
+            options.fade = true;
+        }
+        else if (strcmp(argv[i], "--render=direct") == 0) {
+            options.partial = false;
+        }
+        else if (strcmp(argv[i], "--render=partial") == 0) {
+            options.partial = true;
+        }
+        else if (strncmp(argv[i], "--bands=", 8) == 0) {
+            options.bands = LV_MAX(atoi(argv[i] + 8), 1);
+        }
+        else if (strcmp(argv[i], "--band-buffers=1") == 0 || strcmp(argv[i], "--band-buffers=2") == 0) {
+            options.band_buffers = argv[i][15] - '0';
+        }
+        else if (strncmp(argv[i], "--size=", 7) == 0) {
+            if (sscanf(argv[i] + 7, "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                fprintf(stderr, "Invalid size: %s\n", argv[i] + 7);
+                exit(1);
+            }
+        }
+        else if (strncmp(argv[i], "--bench=", 8) == 0) {
+            options.bench_frames = atoi(argv[i] + 8);
+        }
+        else if (strncmp(argv[i], "--simd=", 7) == 0) {
+            options.simd = argv[i] + 7;
+        }
+        else if (strcmp(argv[i], "--blend-bench") == 0) {
+            options.blend_bench = 1000;
+        }
+        else if (strncmp(argv[i], "--blend-bench=", 14) == 0) {
+            options.blend_bench = atoi(argv[i] + 14);
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            options.stats = true;
+        }
+        else if (strncmp(argv[i], "--vsync=", 8) == 0) {
+            if (!frame_pacer_parse_vsync(argv[i] + 8, &options.vsync)) {
+                fprintf(stderr, "Unknown vsync mode: %s\n", argv[i] + 8);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--jit") == 0) {
+            options.jit = true;
+        }
+        else if (strcmp(argv[i], "--offscreen") == 0) {
+            options.offscreen_frames = OFFSCREEN_FRAMES;
+        }
+        else if (strncmp(argv[i], "--offscreen=", 12) == 0) {
+            options.offscreen_frames = LV_MAX(atoi(argv[i] + 12), 1);
+        }
+        else if (strncmp(argv[i], "--record=", 9) == 0) {
+            options.record_file = argv[i] + 9;
+        }
+        else if (strncmp(argv[i], "--replay=", 9) == 0) {
+            options.replay_file = argv[i] + 9;
+        }
+        else if (strncmp(argv[i], "--frame-trace=", 14) == 0) {
+            options.frame_trace_file = argv[i] + 14;
+        }
+        else if (strcmp(argv[i], "--hud") == 0) {
+            options.hud = true;
+        }
+        else if (strcmp(argv[i], "--trace") == 0) {
+            options.trace_file = "trace.json";
+        }
+        else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            options.trace_file = argv[i] + 8;
+        }
+        else if (strcmp(argv[i], "--latency") == 0) {
+            options.latency = true;
+        }
+        else if (strncmp(argv[i], "--latency=", 10) == 0) {
+            options.latency = true;
+            options.latency_file = argv[i] + 10;
+        }
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--loop=event|poll|thread] [--upload=direct|pbo|persistent|persistent-flush] [--no-pbo]\n"
+                            "          [--no-coalesce] [--coalesce-overhead=PIXELS] [--legacy-gl]\n"
+                            "          [--filter=nearest|linear] [--gamma=VALUE] [--draw=sw|gl] [--draw-compare]\n"
+                            "          [--composite] [--spin] [--rotate=0|90|180|270] [--grad-cache=on|off]\n"
+                            "          [--layer-cache=on|off] [--mask-cache=on|off] [--mask-budget=KIB] [--fade]\n"
+                            "          [--render=direct|partial] [--bands=N] [--band-buffers=1|2]\n"
+                            "          [--size=WxH] [--bench=FRAMES] [--simd=none|sse2|avx2] [--blend-bench[=ITERATIONS]] [--stats]\n"
+                            "          [--vsync=on|off|adaptive] [--jit] [--latency[=FILE]] [--offscreen[=FRAMES]]\n"
+                            "          [--record=FILE] [--replay=FILE [--frame-trace=FILE]] [--trace[=FILE]] [--hud]\n",
+                    argv[0]);
+            exit(1);
+        }
+    }
+}
+
+static void allocate_draw_buffer(int width, int height)
+{
+    uint32_t size = width * height * sizeof(lv_color32_t);
+
+    // In the persistent upload modes LVGL renders straight into GPU-visible memory, unless
+    // it runs on its own thread: then the main thread uploads from the frame exchange
+    uint8_t * mapped = options.loop_mode == LOOP_THREADED ? NULL : gl_upload_map_frame(width, height);
+    if (mapped) {
+        if (!buf_mapped)
+            buffer_pool_release(buf, buf_capacity);
+        buf = (lv_color32_t *)mapped;
+        buf_mapped = true;
+    }
+    else {
+        if (buf_mapped)
+            buf = NULL;
+        buf = buffer_pool_resize(buf, &buf_capacity, size);
+        buf_mapped = false;
+    }
+
+    lv_draw_buf_init(&draw_buf, width, height, LV_COLOR_FORMAT_NATIVE,
                      width * sizeof(lv_color32_t),
-                     buf, width * height * sizeof(lv_color32_t));
+                     buf, size);
+}
+
+static int32_t texture_capacity(int32_t size)
+{
+    // 1/8 headroom, in steps of 64 texels
+    return LV_MIN((size + size / 8 + 63) & ~63, max_texture_size);
+}
+
+static void resize_texture(int width, int height)
+{
+    // Re-specify the texture only if the frame outgrew it or now covers less than a
+    // quarter of it; otherwise the presenter just draws the covered part
+    int64_t capacity_px = (int64_t)texture_capacity_width * texture_capacity_height;
+    if (width > texture_capacity_width || height > texture_capacity_height ||
+        (int64_t)width * height * 4 < capacity_px) {
+        texture_capacity_width = texture_capacity(width);
+        texture_capacity_height = texture_capacity(height);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texture_capacity_width, texture_capacity_height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        resize.texture_reallocs++;
+    }
+
+    texture_width = width;
+    texture_height = height;
+    presenter_set_crop((float)width / texture_capacity_width, (float)height / texture_capacity_height);
+    presenter_set_view(width, height, options.rotation);
+}
+
+static void pool_trim_timer_cb(lv_timer_t * timer)
+{
+    buffer_pool_trim();
+    pool_trim_timer = NULL;  // a one-shot timer deletes itself
+}
+
+static void set_display_buffers(int width, int height)
+{
+    if (options.partial) {
+        // Band-sized buffers stay in cache while LVGL renders them, and memory no longer
+        // grows with the full screen size
+        int32_t rows = (height + options.bands - 1) / options.bands;
+        band_size = width * rows * sizeof(lv_color32_t);
+        for (int i = 0; i < options.band_buffers; i++)
+            bands[i] = buffer_pool_resize(bands[i], &band_capacity[i], band_size);
+        lv_display_set_buffers(disp, bands[0], options.band_buffers > 1 ? bands[1] : NULL, band_size,
+                               LV_DISPLAY_RENDER_MODE_PARTIAL);
+        return;
+    }
+
+    allocate_draw_buffer(width, height);
     lv_display_set_buffers(disp, buf, NULL, width * height * sizeof(lv_color32_t), LV_DISPLAY_RENDER_MODE_DIRECT);
+}
+
+static void resize_display(int width, int height)
+{
+    // Update LVGL display resolution
+    lv_display_set_resolution(disp, width, height);
 
-    // Resize the OpenGL texture
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    // Resize the draw buffer
+    set_display_buffers(width, height);
 
     // Update the resolution text
     update_resolution_text(width, height);
+
+    // The retained layers take the new size too
+    compositor_resize(width, height);
+
+    // Runs on whichever thread owns LVGL, which is also the one using the pool
+    if (pool_trim_timer) {
+        lv_timer_reset(pool_trim_timer);
+    }
+    else {
+        pool_trim_timer = lv_timer_create(pool_trim_timer_cb, POOL_TRIM_DELAY, NULL);
+        lv_timer_set_repeat_count(pool_trim_timer, 1);
+    }
+}
+
+static void window_resize_callback(GLFWwindow* window, int width, int height)
+{
+    // A drag reports every intermediate size; only the last one before the loop
+    // comes around again is worth rendering
+    resize.pending = true;
+    resize.width = width;
+    resize.height = height;
+    resize.requests++;
+    needs_present = true;
+}
+
+static void apply_pending_resize(void)
+{
+    if (!resize.pending)
+        return;
+    resize.pending = false;
+    resize.applied++;
+
+    // Update OpenGL viewport
+    glViewport(0, 0, resize.width, resize.height);
+
+    int32_t width, height;
+    frame_size(resize.width, resize.height, &width, &height);
+    if (options.loop_mode == LOOP_THREADED) {
+        // The texture follows once the first frame at the new size arrives
+        app_event_t event = { .type = APP_EVENT_RESIZE, .x = width, .y = height };
+        event_queue_push(&input_queue, &event);
+        render_thread_wake();
+    }
+    else {
+        resize_display(width, height);
+        resize_texture(width, height);
+    }
+
+    needs_present = true;
+}
+
+// Threaded mode, main thread: apply the newest finished frame to the texture
+static void upload_exchanged_frame(void)
+{
+    const exchange_frame_t * frame = frame_exchange_acquire();
+    if (!frame)
+        return;
+
+    if (frame->width != texture_width || frame->height != texture_height)
+        resize_texture(frame->width, frame->height);
+
+    for (int i = 0; i < frame->rects.count; i++)
+        gl_upload_area(&frame->rects.areas[i], frame->pixels, frame->width * sizeof(lv_color32_t));
+    gl_upload_frame_done();
+    texture_frame = frame->sequence;
+    needs_present = true;
+}
+
+// Threaded mode, LVGL thread: everything LVGL does after start-up happens here
+static void render_thread_run(void)
+{
+#if LV_USE_PROFILER
+    trace_profiler_set_thread_name("LVGL");
+#endif
+    while (!render_thread_should_quit()) {
+        app_event_t event;
+        int32_t resize_width = 0, resize_height = 0;
+
+        while (event_queue_pop(&input_queue, &event)) {
+            if (event.type == APP_EVENT_RESIZE) {
+                // Only the last size of a burst matters
+                resize_width = event.x;
+                resize_height = event.y;
+            }
+        }
+        if (resize_width > 0 && resize_height > 0)
+            resize_display(resize_width, resize_height);
+
+        glfw_input_process();
+        uint32_t idle_ms = lv_timer_handler();
+        hud_sample_heap();
+
+        // While the button or a key is held LVGL needs periodic reads for long press and repeat
+        if (glfw_input_is_held() && idle_ms > LV_DEF_REFR_PERIOD)
+            idle_ms = LV_DEF_REFR_PERIOD;
+        render_thread_wait(idle_ms);
+    }
 }
 
 static void label_event_cb(lv_event_t * e)
@@ -121,40 +1053,96 @@ static void label_event_cb(lv_event_t * e)
     }
 }
 
-static void create_gradient_background(lv_obj_t * parent)
+static void spin_anim_cb(void * var, int32_t value)
 {
-    static const lv_color_t grad_colors[2] = {
-        LV_COLOR_MAKE(0x9B, 0x18, 0x42),
-        LV_COLOR_MAKE(0x00, 0x00, 0x00),
-    };
-
-    int32_t width = lv_display_get_horizontal_resolution(NULL);
-    int32_t height = lv_display_get_vertical_resolution(NULL);
+    // Only the layer's quad turns; its content was rendered once
+    lv_area_t coords;
+    lv_obj_get_coords(spin_obj, &coords);
+    compositor_layer_set_transform(spin_layer, value / 10.0f, 1.0f, (coords.x1 + coords.x2 + 1) / 2.0f,
+                                   (coords.y1 + coords.y2 + 1) / 2.0f);
+}
 
-    static lv_style_t style;
-    lv_style_init(&style);
+static void create_spinning_layer(int32_t width, int32_t height)
+{
+    spin_layer = compositor_create_layer(width, height, false);
+    if (!spin_layer) {
+        fprintf(stderr, "Could not create the spinning layer\n");
+        return;
+    }
 
-    static lv_grad_dsc_t grad;
-    lv_gradient_init_stops(&grad, grad_colors, NULL, NULL, sizeof(grad_colors) / sizeof(lv_color_t));
-    lv_grad_radial_init(&grad, LV_GRAD_CENTER, LV_GRAD_CENTER, LV_GRAD_RIGHT, LV_GRAD_BOTTOM, LV_GRAD_EXTEND_PAD);
-    lv_style_set_bg_grad(&style, &grad);
+    spin_obj = lv_obj_create(compositor_layer_get_screen(spin_layer));
+    lv_obj_set_size(spin_obj, 120, 120);
+    lv_obj_align(spin_obj, LV_ALIGN_CENTER, 0, 150);
+    lv_obj_set_style_bg_color(spin_obj, lv_color_hex(0xF0A030), 0);
+    lv_obj_t * label = lv_label_create(spin_obj);
+    lv_label_set_text(label, "GPU");
+    lv_obj_center(label);
 
-    lv_obj_t * obj = lv_obj_create(parent);
-    lv_obj_add_style(obj, &style, 0);
-    lv_obj_set_size(obj, width, height);
-    lv_obj_center(obj);
-    lv_obj_move_to_index(obj, 0);  // Move to the background
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, spin_obj);
+    lv_anim_set_values(&a, 0, 3600);
+    lv_anim_set_duration(&a, 4000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_set_exec_cb(&a, spin_anim_cb);
+    lv_anim_start(&a);
 }
 
-int main(void)
+int main(int argc, char ** argv)
 {
     GLFWwindow* window;
 
+    parse_options(argc, argv);
+
+    if (options.offscreen_frames > 0) {
+        // Nothing is shown and only the FBO is measured: no vsync, no render thread in between
+        if (options.loop_mode == LOOP_THREADED)
+            fprintf(stderr, "--offscreen presents on the LVGL thread, using --loop=event\n");
+        options.loop_mode = LOOP_EVENT;
+        options.vsync = FRAME_PACER_VSYNC_OFF;
+        options.jit = false;
+        options.hud = false;  // measured is the app's own upload and present path
+#ifdef GLFW_PLATFORM_NULL
+        // GLFW 3.4: no display server needed, the context comes from EGL surfaceless (llvmpipe without a GPU)
+        if (glfwPlatformSupported(GLFW_PLATFORM_NULL))
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+    }
+
+    if (options.replay_file) {
+        // The replay's clock is virtual: nothing may wait for real time, and LVGL runs where the loop is
+        if (options.loop_mode == LOOP_THREADED || options.jit || options.latency)
+            fprintf(stderr, "--replay runs the event loop without --jit and --latency\n");
+        options.loop_mode = LOOP_EVENT;
+        options.vsync = FRAME_PACER_VSYNC_OFF;
+        options.jit = false;
+        options.latency = false;
+        options.latency_file = NULL;
+        options.record_file = NULL;
+    }
+
     if (!glfwInit())
         return -1;
 
     glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
-    window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "LVGL with GLFW", NULL, NULL);
+    if (options.offscreen_frames > 0)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = NULL;
+    if (!options.presenter.legacy) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);  // Required on macOS
+        window = glfwCreateWindow(options.width, options.height, "LVGL with GLFW", NULL, NULL);
+    }
+    if (!window) {
+        // No 3.3 core context here; take whatever the driver offers and present with what it supports
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
+        if (options.offscreen_frames > 0)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(options.width, options.height, "LVGL with GLFW", NULL, NULL);
+    }
     if (!window) {
         glfwTerminate();
         return -1;
@@ -162,42 +1150,185 @@ int main(void)
 
     glfwMakeContextCurrent(window);
     glfwSetWindowSizeCallback(window, window_resize_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
+    // Create an OpenGL texture; its storage is sized once the presenter exists
+    glGenTextures(1, &texture);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+    // Pick the presentation and texture upload paths supported by this context
+    gl_ext_load();
+
+    // Record LVGL's profiler points and the GL spans until exit; SIGUSR1 dumps them meanwhile
+    if (options.trace_file) {
+#if LV_USE_PROFILER
+        if (trace_profiler_start(options.trace_file)) {
+            trace_profiler_set_thread_name("main");
+            if (!gl_trace_init())
+                fprintf(stderr, "No GL timer queries on OpenGL %d.%d, tracing the CPU side only\n",
+                        gl_ext.major, gl_ext.minor);
+        }
+        else {
+            fprintf(stderr, "Could not allocate the trace buffer, not tracing\n");
+        }
+#else
+        fprintf(stderr, "Built without LVGL_GLFW_TRACE, --trace ignored\n");
+#endif
+    }
+    if (!presenter_init(texture, &options.presenter)) {
+        fprintf(stderr, "No usable presentation path for OpenGL %d.%d\n", gl_ext.major, gl_ext.minor);
+        glfwTerminate();
+        return -1;
+    }
+    int32_t frame_width, frame_height;
+    frame_size(options.width, options.height, &frame_width, &frame_height);
+    resize_texture(frame_width, frame_height);
+    gl_upload_init(texture, presenter_upload_format(), options.upload_mode);
+    gl_upload_set_coalesce(!options.no_coalesce, options.coalesce_overhead);
+    if (options.hud && !hud_init()) {
+        fprintf(stderr, "Could not set up the HUD, showing the frame counter label\n");
+        options.hud = false;
+    }
+    frame_pacer_init(window, options.vsync);
+    if (options.jit && (options.loop_mode != LOOP_EVENT || frame_pacer_get_vsync() == FRAME_PACER_VSYNC_OFF)) {
+        fprintf(stderr, "--jit paces the event loop to the vblank, it needs --loop=event and vsync\n");
+        options.jit = false;
+    }
+
+    if (options.loop_mode == LOOP_THREADED) {
+        if (options.gl_draw) {
+            fprintf(stderr, "The GL draw unit needs the GL context on the LVGL thread, drawing in SW with --loop=thread\n");
+            options.gl_draw = false;
+        }
+        if (options.partial) {
+            fprintf(stderr, "Frames are handed over whole with --loop=thread, rendering in direct mode\n");
+            options.partial = false;
+        }
+        if (options.composite) {
+            fprintf(stderr, "Layers are uploaded as LVGL flushes them, compositing is not available with --loop=thread\n");
+            options.composite = false;
+        }
+        event_queue_init(&input_queue);
+        dirty_rects_reset(&render_damage);
+        frame_exchange_init();
+    }
+
+    // LVGL starts on the replay's clock, and recording starts with it, so both sessions begin alike
+    if (options.replay_file) {
+        int32_t recorded_width, recorded_height;
+        if (!input_replay_open(options.replay_file, &recorded_width, &recorded_height)) {
+            fprintf(stderr, "Could not read the input recording %s\n", options.replay_file);
+            glfwTerminate();
+            return -1;
+        }
+        if (recorded_width != frame_width || recorded_height != frame_height)
+            fprintf(stderr, "%s was recorded at %dx%d, pointer positions are replayed unscaled\n",
+                    options.replay_file, recorded_width, recorded_height);
+    }
+    if (options.record_file && !input_record_start(options.record_file, frame_width, frame_height))
+        fprintf(stderr, "Could not create %s, not recording\n", options.record_file);
 
     // Initialize LVGL
     lv_init();
+    lv_tick_set_cb(tick_get_cb);
+
+    // Pick the blend kernels before anything is rendered
+    const char * blend_name = "c";
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
+    blend_x86_init();
+    if (options.simd) {
+        blend_x86_level_t level;
+        if (!blend_x86_parse_level(options.simd, &level)) {
+            fprintf(stderr, "Unknown SIMD level: %s\n", options.simd);
+            return -1;
+        }
+        if (blend_x86_set_level(level) != level)
+            fprintf(stderr, "This CPU does not support %s, blending with %s\n", options.simd,
+                    blend_x86_level_name(blend_x86_get_level()));
+    }
+    blend_bench_verify();
+    blend_name = blend_x86_level_name(blend_x86_get_level());
+#else
+    if (options.simd || options.blend_bench)
+        fprintf(stderr, "Built without LVGL_GLFW_SIMD, blending in C\n");
+#endif
+
+    // Optionally hand fills, borders and plain images to the GPU
+    bool gl_draw_ready = (options.gl_draw || options.draw_compare) && gl_draw_init();
+    if ((options.gl_draw || options.draw_compare) && !gl_draw_ready)
+        fprintf(stderr, "GL draw unit unavailable on OpenGL %d.%d, drawing in SW\n", gl_ext.major, gl_ext.minor);
+    gl_draw_set_enabled(options.gl_draw);
+
+    // Opaque gradients are drawn from cached ramps and surfaces, ahead of SW and GL
+    grad_draw_init();
+    grad_draw_set_enabled(options.grad_draw);
 
-    // Initialize the display buffer
-    buf = malloc(WINDOW_WIDTH * WINDOW_HEIGHT * sizeof(lv_color32_t));
-    lv_draw_buf_init(&draw_buf, WINDOW_WIDTH, WINDOW_HEIGHT, LV_COLOR_FORMAT_NATIVE, 
-                     WINDOW_WIDTH * sizeof(lv_color32_t),
-                     buf, WINDOW_WIDTH * WINDOW_HEIGHT * sizeof(lv_color32_t));
+    // Box shadows and rounded fills are blended through cached masks
+    mask_draw_init();
+    mask_draw_set_budget(options.mask_budget);
+    mask_draw_set_enabled(options.mask_draw);
+
+    // Layers of widgets marked with layer_cache_enable are reused while only their opacity or position changes
+    layer_cache_init();
+    layer_cache_set_enabled(options.layer_cache);
+
+    if (options.partial && options.draw_compare) {
+        fprintf(stderr, "--draw-compare needs the whole frame in one buffer, ignored with --render=partial\n");
+        options.draw_compare = false;
+    }
 
     // Initialize the display driver
-    disp = lv_display_create(WINDOW_WIDTH, WINDOW_HEIGHT);
+    disp = lv_display_create(frame_width, frame_height);
     lv_display_set_flush_cb(disp, my_disp_flush);
-    lv_display_set_buffers(disp, buf, NULL, WINDOW_WIDTH * WINDOW_HEIGHT * sizeof(lv_color32_t), LV_DISPLAY_RENDER_MODE_DIRECT);
+    if (options.loop_mode != LOOP_THREADED)
+        lv_display_add_event_cb(disp, render_start_cb, LV_EVENT_RENDER_START, NULL);
+    if (options.composite) {
+        // The main display is blended over the layers, so it needs alpha and a see-through screen
+        lv_display_set_color_format(disp, LV_COLOR_FORMAT_ARGB8888);
+        lv_obj_set_style_bg_opa(lv_screen_active(), LV_OPA_TRANSP, 0);
+    }
+    set_display_buffers(frame_width, frame_height);
 
     // Set the resolution of the display
-    lv_display_set_resolution(disp, WINDOW_WIDTH, WINDOW_HEIGHT);
+    lv_display_set_resolution(disp, frame_width, frame_height);
+
+    // Just in time, the loop decides when LVGL runs: refresh and animate whenever it is called
+    if (options.jit) {
+        lv_timer_set_period(lv_display_get_refr_timer(disp), 1);
+        lv_timer_set_period(lv_anim_get_timer(), 1);
+    }
 
-    // Initialize the input device driver
-    lv_indev_t * mouse_indev = lv_indev_create();
-    lv_indev_set_type(mouse_indev, LV_INDEV_TYPE_POINTER);
-    lv_indev_set_read_cb(mouse_indev, my_mouse_read);
-    lv_indev_set_user_data(mouse_indev, window);
+    // Follow input events to the frame that shows their effect
+    if (options.latency)
+        latency_trace_init(disp);
 
-    // Create gradient background
-    create_gradient_background(lv_scr_act());
+    // Initialize the input devices: GLFW callbacks queue events, the indevs drain them
+    glfw_input_init(window, options.loop_mode != LOOP_POLL,
+                    options.loop_mode == LOOP_THREADED ? render_thread_wake : NULL);
+
+    // Create gradient background, in a layer of its own when compositing: a change
+    // on the main display then no longer repaints and re-uploads the gradient under it
+    compositor_layer_t * background = options.composite ?
+                                      compositor_create_layer(frame_width, frame_height, true) : NULL;
+    if (options.composite && !background)
+        fprintf(stderr, "Could not create the background layer, drawing it on the main display\n");
+    demo_scene_create_background(background ? compositor_layer_get_screen(background) : lv_scr_act());
 
     // Create a label for the resolution
     resolution_label = lv_label_create(lv_scr_act());
     lv_obj_align(resolution_label, LV_ALIGN_TOP_LEFT, 10, 10);
-    update_resolution_text(WINDOW_WIDTH, WINDOW_HEIGHT);
+    update_resolution_text(frame_width, frame_height);
 
-    // Create a label for the frame counter
-    frame_counter_label = lv_label_create(lv_scr_act());
-    lv_obj_align(frame_counter_label, LV_ALIGN_TOP_LEFT, 10, 40);
-    update_frame_counter();
+    // Create a label for the frame counter, unless the HUD shows the frame rate without redrawing LVGL
+    if (!options.hud) {
+        frame_counter_label = lv_label_create(lv_scr_act());
+        lv_obj_align(frame_counter_label, LV_ALIGN_TOP_LEFT, 10, 40);
+        update_frame_counter();
+        if (options.loop_mode != LOOP_POLL) {
+            // Relabelling every iteration would invalidate every frame and keep the loop awake
+            lv_timer_create(frame_counter_timer_cb, FRAME_COUNTER_PERIOD, NULL);
+        }
+    }
 
     // Create a selectable label
     selectable_label = lv_label_create(lv_scr_act());
@@ -207,57 +1338,181 @@ int main(void)
     lv_obj_add_event_cb(selectable_label, label_event_cb, LV_EVENT_ALL, NULL);
 
     // Create three buttons with different colors
-    lv_obj_t * btn_red = lv_btn_create(lv_scr_act());
-    lv_obj_align(btn_red, LV_ALIGN_CENTER, -100, 40);
-    lv_obj_set_style_bg_color(btn_red, lv_color_hex(0xFF0000), 0);
+    demo_scene_create_buttons(lv_scr_act());
 
-    lv_obj_t * btn_green = lv_btn_create(lv_scr_act());
-    lv_obj_align(btn_green, LV_ALIGN_CENTER, 0, 40);
-    lv_obj_set_style_bg_color(btn_green, lv_color_hex(0x00FF00), 0);
+    if (options.fade)
+        demo_scene_create_fading_panel(lv_scr_act());
 
-    lv_obj_t * btn_blue = lv_btn_create(lv_scr_act());
-    lv_obj_align(btn_blue, LV_ALIGN_CENTER, 100, 40);
-    lv_obj_set_style_bg_color(btn_blue, lv_color_hex(0x0000FF), 0);
+    // A widget that turns on the GPU, above the background and below the main display
+    if (options.spin && options.composite)
+        create_spinning_layer(frame_width, frame_height);
 
-    // Create an OpenGL texture
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-
-    printf("GLFW Window: %dx%d\n", WINDOW_WIDTH, WINDOW_HEIGHT);
-    printf("LVGL Display: %dx%d\n", lv_display_get_horizontal_resolution(disp), lv_display_get_vertical_resolution(disp));
-    printf("OpenGL Texture: %dx%d\n", WINDOW_WIDTH, WINDOW_HEIGHT);
+    printf("GLFW Window: %dx%d\n", options.width, options.height);
+    printf("LVGL Display: %dx%d, rotated %d degrees by the presenter\n", lv_display_get_horizontal_resolution(disp),
+           lv_display_get_vertical_resolution(disp), options.rotation * 90);
+    printf("OpenGL Texture: %dx%d (%dx%d allocated)\n", texture_width, texture_height,
+           texture_capacity_width, texture_capacity_height);
     printf("LVGL Color Depth: %d bits\n", LV_COLOR_DEPTH);
+    if (options.partial) {
+        printf("LVGL Render Mode: partial, %d x %.1f KiB bands\n", options.band_buffers, band_size / 1024.0);
+    }
+    else {
+        printf("LVGL Render Mode: direct, %.1f KiB frame\n", draw_buffer_bytes() / 1024.0);
+    }
+    printf("OpenGL %d.%d %s, presenter: %s, texture upload: %s, draw: %s, blend: %s\n", gl_ext.major, gl_ext.minor,
+           gl_ext.core_profile ? "core" : "compatibility",
+           presenter_uses_shader() ? "shader" : "fixed-function", gl_upload_mode_name(gl_upload_get_mode()),
+           gl_draw_is_enabled() ? "gl" : "sw", blend_name);
+    printf("Vsync: %s%s\n", frame_pacer_vsync_name(frame_pacer_get_vsync()), options.jit ? ", frames started just in time" : "");
+    printf("Gradients: %s, masks: %s (%.0f KiB budget), layer cache: %s, compositor layers: %d\n",
+           grad_draw_is_enabled() ? "cached" : "sw", mask_draw_is_enabled() ? "cached" : "sw",
+           mask_draw_get_budget() / 1024.0, layer_cache_is_enabled() ? "on" : "off", compositor_layer_count());
+
+    if (options.draw_compare)
+        compare_draw_units(gl_draw_ready);
+    if (options.bench_frames > 0) {
+        run_benchmark(options.bench_frames);
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+    if (options.offscreen_frames > 0) {
+        run_offscreen(options.offscreen_frames);
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+    if (options.replay_file) {
+        run_replay(window);
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
+    if (options.blend_bench > 0) {
+        blend_bench_run(options.blend_bench);
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+#endif
+
+    if (options.loop_mode == LOOP_THREADED) {
+        // From here on LVGL belongs to the render thread
+        if (!render_thread_start(render_thread_run)) {
+            fprintf(stderr, "Could not start the render thread\n");
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+
+    double next_stats = glfwGetTime() + STATS_INTERVAL;
+    uint32_t loop_iterations = 0;
 
     while (!glfwWindowShouldClose(window)) {
-        lv_timer_handler();
+        apply_pending_resize();
+        frame_pacer_begin();
 
-        // Clear the screen
-        glClear(GL_COLOR_BUFFER_BIT);
+        uint32_t idle_ms = LV_NO_TIMER_READY;  // the render thread wakes us when it has a frame
+        if (options.loop_mode == LOOP_THREADED)
+            upload_exchanged_frame();
+        else {
+            glfw_input_process();
+            idle_ms = lv_timer_handler();
+            hud_sample_heap();
+        }
+        if (compositor_take_damage())
+            needs_present = true;
 
-        // Draw a fullscreen quad with the LVGL texture
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 1); glVertex2f(-1, -1);
-        glTexCoord2f(1, 1); glVertex2f(1, -1);
-        glTexCoord2f(1, 0); glVertex2f(1, 1);
-        glTexCoord2f(0, 0); glVertex2f(-1, 1);
-        glEnd();
-
-        // Update the frame counter
-        update_frame_counter();
+        // Nothing was flushed and the window was not damaged: the last frame is still on screen
+        if (needs_present) {
+            LV_PROFILER_BEGIN_TAG("presenter_draw");
+            gl_trace_begin("presenter_draw");
+            presenter_draw();
+            gl_trace_end();
+            LV_PROFILER_END_TAG("presenter_draw");
+            frame_pacer_swap();
+            gl_trace_collect();
+            hud_frame_presented();
+            if (latency_trace_is_enabled())
+                latency_trace_present(options.loop_mode == LOOP_THREADED ? texture_frame : latency_trace_get_frames());
+            frame_count++;
+            needs_present = false;
+        }
+        else {
+            frames_skipped++;
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if (options.loop_mode != LOOP_POLL) {
+            // Wake up for the next --stats report even when the UI is idle
+            if (options.stats || options.latency) {
+                double until_stats = (next_stats - glfwGetTime()) * 1000.0;
+                uint32_t stats_ms = until_stats > 0 ? (uint32_t)until_stats : 0;
+                if (stats_ms < idle_ms)
+                    idle_ms = stats_ms;
+            }
+#if LV_USE_PROFILER
+            // ... and to write the trace SIGUSR1 asked for
+            if (options.trace_file && idle_ms > TRACE_POLL_MS)
+                idle_ms = TRACE_POLL_MS;
+#endif
+            wait_for_events(window, idle_ms);
+            if (options.jit)
+                frame_pacer_wait_for_slot();
+        }
+        else {
+            // Update the frame counter
+            update_frame_counter();
+            glfwPollEvents();
+        }
+
+#if LV_USE_PROFILER
+        trace_profiler_poll();
+#endif
+
+        loop_iterations++;
+        if ((options.stats || options.latency) && glfwGetTime() >= next_stats) {
+            print_stats("stats", &loop_iterations);
+            next_stats += STATS_INTERVAL;
+        }
+    }
+
+    if (options.loop_mode == LOOP_THREADED)
+        render_thread_stop();
+    input_record_stop();
+
+#if LV_USE_PROFILER
+    if (options.trace_file) {
+        int events = trace_profiler_dump();
+        if (events < 0)
+            fprintf(stderr, "Could not write %s\n", options.trace_file);
+        else
+            printf("[exit] trace: %d events written to %s\n", events, options.trace_file);
+    }
+#endif
 
-        lv_tick_inc(16); // Assuming 60 FPS
+    if (options.stats || options.latency)
+        print_stats("exit", &loop_iterations);
+    if (options.latency_file) {
+        int rows = latency_trace_write(options.latency_file);
+        if (rows < 0)
+            fprintf(stderr, "Could not write %s\n", options.latency_file);
+        else
+            printf("[exit] latency: %d events written to %s\n", rows, options.latency_file);
     }
 
     // Clean up
-    free(buf);
+    if (!buf_mapped)
+        buffer_pool_release(buf, buf_capacity);
+    buffer_pool_release(bands[0], band_capacity[0]);
+    buffer_pool_release(bands[1], band_capacity[1]);
+    gl_draw_deinit();
+    grad_draw_set_enabled(false);
+    mask_draw_set_enabled(false);
+    layer_cache_set_enabled(false);
+    latency_trace_deinit();
+    input_replay_close();
+    gl_trace_deinit();
+#if LV_USE_PROFILER
+    trace_profiler_stop();
+#endif
+    compositor_deinit();
+    frame_exchange_deinit();
+    gl_upload_deinit();
+    hud_deinit();
+    presenter_deinit();
+    buffer_pool_trim();  // last: the compositor and the frame exchange release into the pool
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
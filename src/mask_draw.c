@@ -0,0 +1,455 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "lvgl_private.h"  // lv_draw_unit_t, lv_draw_task_t, lv_layer_t internals
+#include "mask_draw.h"
+#include "lru_cache.h"
+
+#if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM && defined(__x86_64__) && defined(__GNUC__)
+#define MASK_DRAW_SIMD 1
+#include "blend_x86.h"
+#else
+#define MASK_DRAW_SIMD 0
+#endif
+
+#define DRAW_UNIT_ID_MASK 23    // next to the layer cache's id
+#define MASK_DRAW_PREFERENCE 75 // below the GL unit's 80: a masked blend beats its round trip
+
+enum {
+    MASK_FILL,
+    MASK_SHADOW,
+};
+
+typedef struct {
+    int32_t kind;
+    int32_t width;      // of the object, before the spread
+    int32_t height;
+    int32_t radius;
+    int32_t spread;
+    int32_t blur;       // shadow width
+} mask_key_t;
+
+// The outline of a mask and where it sits for one task
+typedef struct {
+    int32_t width;      // the whole mask, blur included
+    int32_t height;
+    int32_t shape_width;
+    int32_t shape_height;
+    int32_t radius;
+    int32_t inset;      // half the blur
+    lv_point_t origin;
+} mask_shape_t;
+
+typedef struct {
+    lru_slot_t slot;
+    mask_key_t key;
+    uint8_t *block;     // top-left corner of the mask, block_width x block_height
+    int32_t block_width;
+    int32_t block_height;
+} mask_entry_t;
+
+static void release_entry(void *entry)
+{
+    free(((mask_entry_t *)entry)->block);
+}
+
+static lv_draw_unit_t *unit;
+static bool enabled;
+static mask_entry_t entries[MASK_DRAW_CACHE_ENTRIES];
+static lru_cache_t cache = LRU_CACHE_INIT(entries, mask_entry_t, key, MASK_DRAW_DEFAULT_BUDGET, release_entry);
+static uint8_t *row_mask;
+static int32_t row_mask_capacity;
+static mask_draw_stats_t stats;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Everything the mask depends on, zero-padded so keys compare with memcmp. The
+// color, opacity and shadow offset only matter while blending.
+static bool make_shape(const lv_draw_task_t *t, mask_key_t *key, mask_shape_t *shape)
+{
+    memset(key, 0, sizeof(*key));
+    memset(shape, 0, sizeof(*shape));
+    int32_t w = lv_area_get_width(&t->area);
+    int32_t h = lv_area_get_height(&t->area);
+    key->width = w;
+    key->height = h;
+
+    if (t->type == LV_DRAW_TASK_TYPE_FILL) {
+        const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+        key->kind = MASK_FILL;
+        key->radius = LV_MIN(dsc->radius, LV_MIN(w, h) / 2);
+        shape->origin.x = t->area.x1;
+        shape->origin.y = t->area.y1;
+    }
+    else {
+        const lv_draw_box_shadow_dsc_t *dsc = t->draw_dsc;
+        key->kind = MASK_SHADOW;
+        key->radius = LV_MIN(dsc->radius, LV_MIN(w, h) / 2);
+        key->spread = dsc->spread;
+        key->blur = dsc->width;
+        shape->inset = dsc->width / 2;
+        shape->origin.x = t->area.x1 - dsc->spread + dsc->ofs_x - shape->inset;
+        shape->origin.y = t->area.y1 - dsc->spread + dsc->ofs_y - shape->inset;
+    }
+
+    shape->shape_width = w + 2 * key->spread;
+    shape->shape_height = h + 2 * key->spread;
+    if (shape->shape_width <= 0 || shape->shape_height <= 0)
+        return false;
+    shape->radius = LV_CLAMP(0, key->radius + key->spread, LV_MIN(shape->shape_width, shape->shape_height) / 2);
+    shape->width = shape->shape_width + 2 * shape->inset;
+    shape->height = shape->shape_height + 2 * shape->inset;
+    return true;
+}
+
+// Anti-aliased coverage of a pixel by the rounded rectangle at (x0, y0)
+static uint8_t coverage(int32_t x, int32_t y, int32_t x0, int32_t y0, const mask_shape_t *shape)
+{
+    int32_t x1 = x0 + shape->shape_width;
+    int32_t y1 = y0 + shape->shape_height;
+    if (x < x0 || x >= x1 || y < y0 || y >= y1)
+        return 0;
+
+    int32_t r = shape->radius;
+    float px = x + 0.5f;
+    float py = y + 0.5f;
+    float cx = LV_CLAMP(x0 + r, px, x1 - r);
+    float cy = LV_CLAMP(y0 + r, py, y1 - r);
+    if (r == 0 || (cx == px) || (cy == py))
+        return 255;
+
+    float d = sqrtf((px - cx) * (px - cx) + (py - cy) * (py - cy));
+    float c = r - d + 0.5f;
+    return c >= 1.0f ? 255 : c <= 0.0f ? 0 : (uint8_t)(c * 255.0f + 0.5f);
+}
+
+// One pass of a box blur over `size` values `step` apart, through `line`
+static void blur_line(uint8_t *data, int32_t size, int32_t step, int32_t window, uint8_t *line)
+{
+    int32_t half = window / 2;
+    for (int32_t i = 0; i < size; i++)
+        line[i] = data[i * step];
+
+    uint32_t sum = 0;
+    for (int32_t i = -half; i <= half; i++)
+        sum += i >= 0 && i < size ? line[i] : 0;
+    for (int32_t i = 0; i < size; i++) {
+        data[i * step] = (uint8_t)(sum / window);
+        int32_t out = i - half;
+        int32_t in = i + half + 1;
+        sum -= out >= 0 ? line[out] : 0;
+        sum += in < size ? line[in] : 0;
+    }
+}
+
+// The top-left block of the mask. Beyond it the values repeat along the straight
+// edges, so the shape is built at a size just large enough to contain the
+// corner and its blur, and the block cut from it.
+static uint8_t *build_block(const mask_shape_t *shape, int32_t *block_width, int32_t *block_height)
+{
+    int32_t corner = shape->radius + 2 * shape->inset + 1;
+    int32_t vw = LV_MIN(shape->width, 2 * corner + 2);
+    int32_t vh = LV_MIN(shape->height, 2 * corner + 2);
+    *block_width = LV_MIN(corner, (shape->width + 1) / 2);
+    *block_height = LV_MIN(corner, (shape->height + 1) / 2);
+
+    mask_shape_t virtual_shape = *shape;
+    virtual_shape.shape_width = vw - 2 * shape->inset;
+    virtual_shape.shape_height = vh - 2 * shape->inset;
+
+    uint8_t *canvas = malloc((size_t)vw * vh + LV_MAX(vw, vh));
+    uint8_t *block = malloc((size_t)*block_width * *block_height);
+    if (!canvas || !block) {
+        free(canvas);
+        free(block);
+        return NULL;
+    }
+
+    for (int32_t y = 0; y < vh; y++) {
+        for (int32_t x = 0; x < vw; x++)
+            canvas[(size_t)y * vw + x] = coverage(x, y, shape->inset, shape->inset, &virtual_shape);
+    }
+    if (shape->inset > 0) {
+        uint8_t *line = canvas + (size_t)vw * vh;
+        int32_t window = 2 * shape->inset + 1;
+        for (int32_t y = 0; y < vh; y++)
+            blur_line(canvas + (size_t)y * vw, vw, 1, window, line);
+        for (int32_t x = 0; x < vw; x++)
+            blur_line(canvas + x, vh, vw, window, line);
+    }
+
+    for (int32_t y = 0; y < *block_height; y++)
+        memcpy(block + (size_t)y * *block_width, canvas + (size_t)y * vw, *block_width);
+    free(canvas);
+    return block;
+}
+
+// The cached mask for key, or a new one. *temporary is set when the mask does
+// not fit the budget; the caller frees it after drawing.
+static mask_entry_t *get_entry(const mask_key_t *key, const mask_shape_t *shape, mask_entry_t *temporary)
+{
+    mask_entry_t *e = lru_cache_lookup(&cache, key);
+    if (e) {
+        stats.hits++;
+        return e;
+    }
+
+    memset(temporary, 0, sizeof(*temporary));
+    temporary->key = *key;
+    temporary->block = build_block(shape, &temporary->block_width, &temporary->block_height);
+    if (!temporary->block)
+        return NULL;
+    e = lru_cache_insert(&cache, (size_t)temporary->block_width * temporary->block_height, &stats.evictions);
+    if (!e) {
+        stats.uncached++;
+        return temporary;
+    }
+    e->key = *key;
+    e->block = temporary->block;
+    e->block_width = temporary->block_width;
+    e->block_height = temporary->block_height;
+    stats.misses++;
+    return e;
+}
+
+// Row y of the mask from x to x + count, mirroring the block into the other
+// corners and repeating its last row and column along the edges
+static void mask_row(uint8_t *out, const mask_entry_t *e, const mask_shape_t *shape, int32_t x, int32_t y,
+                     int32_t count)
+{
+    int32_t qy = LV_MIN(y, shape->height - 1 - y);
+    const uint8_t *row = e->block + (size_t)LV_MIN(qy, e->block_height - 1) * e->block_width;
+    for (int32_t i = 0; i < count; i++) {
+        int32_t qx = LV_MIN(x + i, shape->width - 1 - (x + i));
+        out[i] = row[LV_MIN(qx, e->block_width - 1)];
+    }
+}
+
+// LVGL's lv_color_24_24_mix on the color channels; the X byte is left alone
+static void blend_row_xrgb(uint8_t *dst, const uint8_t *mask, int32_t count, uint32_t color, lv_opa_t opa)
+{
+    uint8_t src[3] = { color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF };
+    for (int32_t i = 0; i < count; i++, dst += 4) {
+        uint32_t mix = opa >= LV_OPA_MAX ? mask[i] : (mask[i] * opa) >> 8;
+        if (mix == 0)
+            continue;
+        if (mix >= LV_OPA_MAX) {
+            memcpy(dst, src, 3);
+            continue;
+        }
+        uint32_t mix_inv = 255 - mix;
+        for (int c = 0; c < 3; c++)
+            dst[c] = (src[c] * mix + dst[c] * mix_inv) >> 8;
+    }
+}
+
+// Source-over into a layer with alpha, as lv_color_32_32_mix
+static void blend_row_argb(uint8_t *dst, const uint8_t *mask, int32_t count, uint32_t color, lv_opa_t opa)
+{
+    uint8_t src[3] = { color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF };
+    for (int32_t i = 0; i < count; i++, dst += 4) {
+        uint32_t fg_alpha = opa >= LV_OPA_MAX ? mask[i] : (mask[i] * opa) >> 8;
+        if (fg_alpha <= LV_OPA_MIN)
+            continue;
+        if (fg_alpha >= LV_OPA_MAX) {
+            memcpy(dst, src, 3);
+            dst[3] = 0xFF;
+            continue;
+        }
+        uint32_t bg_alpha = dst[3];
+        uint32_t alpha = 255 - (((255 - fg_alpha) * (255 - bg_alpha)) >> 8);
+        uint32_t ratio = (fg_alpha * 255) / alpha;
+        for (int c = 0; c < 3; c++)
+            dst[c] = (src[c] * ratio + dst[c] * (255 - ratio)) >> 8;
+        dst[3] = (uint8_t)alpha;
+    }
+}
+
+static void blend_row(uint8_t *dst, const uint8_t *mask, int32_t count, lv_color_t color, lv_opa_t opa,
+                      bool has_alpha)
+{
+    if (has_alpha) {
+        blend_row_argb(dst, mask, count, lv_color_to_u32(color), opa);
+        return;
+    }
+
+#if MASK_DRAW_SIMD
+    lv_draw_sw_blend_fill_dsc_t dsc = {
+        .dest_buf = dst,
+        .dest_w = count,
+        .dest_h = 1,
+        .dest_stride = count * 4,
+        .mask_buf = mask,
+        .mask_stride = count,
+        .color = color,
+        .opa = opa,
+    };
+    if (blend_x86_color_mix(&dsc, 4) == LV_RESULT_OK)
+        return;
+#endif
+    blend_row_xrgb(dst, mask, count, lv_color_to_u32(color), opa);
+}
+
+static bool draw_task(lv_layer_t *layer, const lv_draw_task_t *t)
+{
+    mask_key_t key;
+    mask_shape_t shape;
+    if (!make_shape(t, &key, &shape))
+        return false;
+
+    lv_area_t mask_area = { shape.origin.x, shape.origin.y, shape.origin.x + shape.width - 1,
+                            shape.origin.y + shape.height - 1 };
+    lv_area_t area;
+    if (!lv_area_intersect(&area, &mask_area, &t->clip_area) || !lv_area_intersect(&area, &area, &layer->buf_area))
+        return true;
+
+    int32_t width = lv_area_get_width(&area);
+    if (width > row_mask_capacity) {
+        uint8_t *grown = realloc(row_mask, width);
+        if (!grown)
+            return false;
+        row_mask = grown;
+        row_mask_capacity = width;
+    }
+
+    mask_entry_t temporary;
+    mask_entry_t *e = get_entry(&key, &shape, &temporary);
+    if (!e)
+        return false;
+
+    lv_color_t color;
+    lv_opa_t opa;
+    if (t->type == LV_DRAW_TASK_TYPE_FILL) {
+        const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+        color = dsc->color;
+        opa = dsc->opa;
+        stats.fills++;
+    }
+    else {
+        const lv_draw_box_shadow_dsc_t *dsc = t->draw_dsc;
+        color = dsc->color;
+        opa = dsc->opa;
+        stats.shadows++;
+    }
+
+    bool has_alpha = layer->color_format == LV_COLOR_FORMAT_ARGB8888;
+    for (int32_t y = area.y1; y <= area.y2; y++) {
+        uint8_t *dst = lv_draw_buf_goto_xy(layer->draw_buf, area.x1 - layer->buf_area.x1, y - layer->buf_area.y1);
+        mask_row(row_mask, e, &shape, area.x1 - shape.origin.x, y - shape.origin.y, width);
+        blend_row(dst, row_mask, width, color, opa, has_alpha);
+    }
+
+    if (e == &temporary)
+        free(temporary.block);
+    stats.pixels += (uint64_t)width * lv_area_get_height(&area);
+    return true;
+}
+
+static bool can_draw(const lv_draw_task_t *t)
+{
+    if (t->type == LV_DRAW_TASK_TYPE_FILL) {
+        // Square fills need no mask, gradients are left to the other units
+        const lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+        return dsc->radius > 0 && dsc->opa > LV_OPA_MIN && dsc->grad.dir == LV_GRAD_DIR_NONE;
+    }
+    if (t->type == LV_DRAW_TASK_TYPE_BOX_SHADOW) {
+        // Under a translucent object SW cuts the object's rounded area out of the
+        // shadow; the masks here cover the whole rectangle
+        const lv_draw_box_shadow_dsc_t *dsc = t->draw_dsc;
+        return dsc->opa > LV_OPA_MIN && dsc->bg_cover;
+    }
+    return false;
+}
+
+static int32_t evaluate_cb(lv_draw_unit_t *draw_unit, lv_draw_task_t *t)
+{
+    if (enabled && t->preference_score > MASK_DRAW_PREFERENCE && can_draw(t)) {
+        t->preference_score = MASK_DRAW_PREFERENCE;
+        t->preferred_draw_unit_id = DRAW_UNIT_ID_MASK;
+    }
+    return 0;
+}
+
+static int32_t dispatch_cb(lv_draw_unit_t *draw_unit, lv_layer_t *layer)
+{
+    // The next task that is ready to draw and was given to this unit
+    lv_draw_task_t *t = NULL;
+    do {
+        t = lv_draw_get_next_available_task(layer, t, DRAW_UNIT_ID_MASK);
+    } while (t && t->preferred_draw_unit_id != DRAW_UNIT_ID_MASK);
+    if (!t)
+        return LV_DRAW_UNIT_IDLE;
+
+    double start = now_ms();
+    if ((layer->color_format != LV_COLOR_FORMAT_XRGB8888 && layer->color_format != LV_COLOR_FORMAT_ARGB8888) ||
+        !lv_draw_layer_alloc_buf(layer)) {
+        t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+        return LV_DRAW_UNIT_IDLE;
+    }
+
+    t->state = LV_DRAW_TASK_STATE_IN_PROGRESS;
+    if (!draw_task(layer, t)) {
+        // Out of memory or an empty shape: SW draws it as usual
+        t->state = LV_DRAW_TASK_STATE_QUEUED;
+        t->preferred_draw_unit_id = LV_DRAW_UNIT_NONE;
+        return LV_DRAW_UNIT_IDLE;
+    }
+    stats.ms += now_ms() - start;
+    t->state = LV_DRAW_TASK_STATE_READY;
+
+    lv_draw_dispatch_request();
+    return 1;
+}
+
+void mask_draw_init(void)
+{
+    if (!unit) {
+        unit = lv_draw_create_unit(sizeof(lv_draw_unit_t));
+        unit->evaluate_cb = evaluate_cb;
+        unit->dispatch_cb = dispatch_cb;
+    }
+    enabled = true;
+}
+
+void mask_draw_set_enabled(bool enable)
+{
+    enabled = enable && unit;
+    if (enabled)
+        return;
+
+    lru_cache_clear(&cache);
+    free(row_mask);
+    row_mask = NULL;
+    row_mask_capacity = 0;
+}
+
+bool mask_draw_is_enabled(void)
+{
+    return enabled;
+}
+
+void mask_draw_set_budget(size_t bytes)
+{
+    lru_cache_set_budget(&cache, bytes, &stats.evictions);
+}
+
+size_t mask_draw_get_budget(void)
+{
+    return cache.budget;
+}
+
+void mask_draw_get_stats(mask_draw_stats_t *out, bool reset)
+{
+    *out = stats;
+    out->cached_bytes = (uint32_t)cache.cached_bytes;
+    out->budget = (uint32_t)cache.budget;
+    if (reset)
+        memset(&stats, 0, sizeof(stats));
+}
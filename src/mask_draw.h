@@ -0,0 +1,54 @@
+#ifndef MASK_DRAW_H
+#define MASK_DRAW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// An LVGL draw unit for box shadows and solid rounded fills, drawn by blending
+// their color through a cached coverage mask. LVGL's own caches are sized at
+// compile time (LV_DRAW_SW_SHADOW_CACHE_SIZE is 0 here, so every shadow is
+// blurred again on each redraw) and keep corner masks for a few radii only.
+//
+// A mask is keyed by size, radius, spread and blur width. As shapes are
+// symmetric and constant along their straight edges, only the top-left corner
+// block is kept (a quadrant for small shapes) and mirrored while drawing. The
+// blur is a box blur over the shadow width in both directions, like LVGL's.
+//
+// Masks are evicted least recently used first to stay within a byte budget
+// that can be changed at run time. Shadows of translucent objects (bg_cover
+// unset), gradients, outlines and the rest stay with the SW (and GL) units.
+
+#define MASK_DRAW_DEFAULT_BUDGET (1024 * 1024)
+#define MASK_DRAW_CACHE_ENTRIES 64
+
+typedef struct {
+    uint32_t shadows;
+    uint32_t fills;
+    uint32_t hits;
+    uint32_t misses;        // masks built
+    uint32_t evictions;
+    uint32_t uncached;      // masks larger than the budget, built for one task only
+    uint32_t cached_bytes;
+    uint32_t budget;
+    uint64_t pixels;
+    double ms;              // drawing, including building masks
+} mask_draw_stats_t;
+
+// Call after lv_init(). Blending uses the SIMD level of blend_x86.h when built
+// with LVGL_GLFW_SIMD, plain C otherwise.
+void mask_draw_init(void);
+
+// Turning the unit off releases its masks and leaves shadows and rounded fills
+// to SW.
+void mask_draw_set_enabled(bool enabled);
+bool mask_draw_is_enabled(void);
+
+// Evicts down to the new budget right away.
+void mask_draw_set_budget(size_t bytes);
+size_t mask_draw_get_budget(void);
+
+// Call on the thread LVGL runs on, as the counters are not atomic.
+void mask_draw_get_stats(mask_draw_stats_t *stats, bool reset);
+
+#endif // MASK_DRAW_H
@@ -0,0 +1,70 @@
+#include <stdlib.h>
+#include "gl_ext.h"
+#include "offscreen.h"
+
+static GLuint fbo;
+static GLuint color;
+static int32_t fbo_width;
+static int32_t fbo_height;
+
+bool offscreen_init(int32_t width, int32_t height)
+{
+    if (!gl_ext.fbo)
+        return false;
+
+    glGenTextures(1, &color);
+    glBindTexture(GL_TEXTURE_2D, color);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    gl_ext.GenFramebuffers(1, &fbo);
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl_ext.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    bool complete = gl_ext.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        offscreen_deinit();
+        return false;
+    }
+
+    fbo_width = width;
+    fbo_height = height;
+    return true;
+}
+
+void offscreen_deinit(void)
+{
+    if (fbo)
+        gl_ext.DeleteFramebuffers(1, &fbo);
+    if (color)
+        glDeleteTextures(1, &color);
+    fbo = 0;
+    color = 0;
+    fbo_width = fbo_height = 0;
+}
+
+void offscreen_bind(void)
+{
+    // Other passes (the GL draw unit) bind framebuffers of their own in between
+    gl_ext.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, fbo_width, fbo_height);
+}
+
+uint32_t offscreen_checksum(void)
+{
+    size_t size = (size_t)fbo_width * fbo_height * 4;
+    uint8_t *px = malloc(size);
+    if (!px)
+        return 0;
+
+    offscreen_bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, fbo_width, fbo_height, GL_RGBA, GL_UNSIGNED_BYTE, px);
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ px[i]) * 16777619u;
+    free(px);
+    return hash;
+}
@@ -0,0 +1,24 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A framebuffer object standing in for the window's, so the texture upload and
+// the presenter run unchanged where nothing can be shown: a hidden window, or
+// GLFW's null platform with an EGL surfaceless context (Mesa llvmpipe on
+// machines without a GPU).
+
+// Needs a current context with framebuffer objects. Returns false if they are
+// missing or the framebuffer is incomplete.
+bool offscreen_init(int32_t width, int32_t height);
+void offscreen_deinit(void);
+
+// Bind the framebuffer and cover it with the viewport, for presenter_draw.
+void offscreen_bind(void);
+
+// Read the framebuffer back and hash it (FNV-1a), to notice when a change to
+// the GL path alters what is presented.
+uint32_t offscreen_checksum(void);
+
+#endif // OFFSCREEN_H
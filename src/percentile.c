@@ -0,0 +1,19 @@
+#include <stdlib.h>
+#include "percentile.h"
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void percentile_sort(double *values, uint32_t count)
+{
+    qsort(values, count, sizeof(double), compare_double);
+}
+
+double percentile(const double *sorted, uint32_t count, double p)
+{
+    uint32_t rank = (uint32_t)(p * count + 0.999999);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
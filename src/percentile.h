@@ -0,0 +1,14 @@
+#ifndef PERCENTILE_H
+#define PERCENTILE_H
+
+#include <stdint.h>
+
+// Nearest-rank percentiles of timings, shared by the reports that print them.
+
+// Sort `count` values in ascending order, in place.
+void percentile_sort(double *values, uint32_t count);
+
+// The `p` (0..1) percentile of `count` > 0 sorted values, by nearest rank.
+double percentile(const double *sorted, uint32_t count, double p);
+
+#endif // PERCENTILE_H
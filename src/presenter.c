@@ -0,0 +1,332 @@
+#include "presenter.h"
+#include "gl_shader.h"
+
+#define ATTRIB_POS 0
+#define ATTRIB_UV 1
+
+static const char *vertex_src =
+    "ATTRIBUTE vec2 a_pos;\n"
+    "ATTRIBUTE vec2 a_uv;\n"
+    "uniform vec2 u_crop;\n"
+    "uniform vec3 u_position_x;  // affine map from the frame's unit square to clip space\n"
+    "uniform vec3 u_position_y;\n"
+    "VARYING_OUT vec2 v_uv;\n"
+    "void main() {\n"
+    "    vec3 unit = vec3(a_pos.x * 0.5 + 0.5, 0.5 - a_pos.y * 0.5, 1.0);\n"
+    "    v_uv = a_uv * u_crop;\n"
+    "    gl_Position = vec4(dot(u_position_x, unit), dot(u_position_y, unit), 0.0, 1.0);\n"
+    "}\n";
+
+static const char *fragment_src =
+    "uniform sampler2D u_texture;\n"
+    "uniform float u_inv_gamma;\n"
+    "uniform float u_blend;\n"
+    "VARYING_IN vec2 v_uv;\n"
+    "void main() {\n"
+    "    // LVGL's XRGB8888 is B, G, R, X in memory and was uploaded as RGBA bytes\n"
+    "    vec4 texel = TEXTURE(u_texture, v_uv);\n"
+    "    vec3 color = texel.bgr;\n"
+    "    if (u_inv_gamma != 1.0)\n"
+    "        color = pow(color, vec3(u_inv_gamma));\n"
+    "    // The fourth byte is only alpha for blended (ARGB8888) textures\n"
+    "    FRAG_COLOR = vec4(color, mix(1.0, texel.a, u_blend));\n"
+    "}\n";
+
+// x, y, u, v as a triangle strip; v is flipped because LVGL's first row is the top one
+static const GLfloat quad[] = {
+    -1.0f, -1.0f, 0.0f, 1.0f,
+     1.0f, -1.0f, 1.0f, 1.0f,
+    -1.0f,  1.0f, 0.0f, 0.0f,
+     1.0f,  1.0f, 1.0f, 0.0f,
+};
+
+// x' = a * x + b * y + c, y' = d * x + e * y + f
+typedef struct {
+    float a, b, c;
+    float d, e, f;
+} affine_t;
+
+static const affine_t identity = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+
+static GLuint texture;
+static presenter_filter_t filter_mode;
+static bool use_shader;
+static GLuint program;
+static GLuint vao;
+static GLuint vbo;
+static GLint crop_location;
+static GLint blend_location;
+static GLint position_x_location;
+static GLint position_y_location;
+static int32_t frame_width = 1;
+static int32_t frame_height = 1;
+static presenter_rotation_t rotation;
+static float crop_u = 1.0f;
+static float crop_v = 1.0f;
+static presenter_layer_t layers[PRESENTER_MAX_LAYERS];
+static int layer_count;
+static presenter_overlay_cb_t overlay;
+
+static bool create_program(float gamma)
+{
+    static const char * const attribs[] = { "a_pos", "a_uv" };  // ATTRIB_POS, ATTRIB_UV
+    program = gl_shader_build(vertex_src, fragment_src, attribs, 2);
+    if (!program)
+        return false;
+
+    gl_ext.UseProgram(program);
+    gl_ext.Uniform1i(gl_ext.GetUniformLocation(program, "u_texture"), 0);
+    gl_ext.Uniform1f(gl_ext.GetUniformLocation(program, "u_inv_gamma"), gamma > 0.0f ? 1.0f / gamma : 1.0f);
+    crop_location = gl_ext.GetUniformLocation(program, "u_crop");
+    blend_location = gl_ext.GetUniformLocation(program, "u_blend");
+    position_x_location = gl_ext.GetUniformLocation(program, "u_position_x");
+    position_y_location = gl_ext.GetUniformLocation(program, "u_position_y");
+    gl_ext.UseProgram(0);
+    return true;
+}
+
+static void bind_quad_attribs(void)
+{
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_ext.EnableVertexAttribArray(ATTRIB_POS);
+    gl_ext.VertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (const void *)0);
+    gl_ext.EnableVertexAttribArray(ATTRIB_UV);
+    gl_ext.VertexAttribPointer(ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
+                               (const void *)(2 * sizeof(GLfloat)));
+}
+
+static void set_texture_params(GLuint tex)
+{
+    GLint filter = filter_mode == PRESENTER_FILTER_NEAREST ? GL_NEAREST : GL_LINEAR;
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+bool presenter_init(GLuint tex, const presenter_config_t *config)
+{
+    texture = tex;
+    use_shader = false;
+    filter_mode = config->filter;
+    set_texture_params(texture);
+
+    if (config->legacy || !gl_ext.shaders)
+        return !gl_ext.core_profile;
+
+    // Vertex arrays are mandatory in a core profile, optional before GL 3.0
+    if (gl_ext.core_profile && !gl_ext.vao)
+        return false;
+    if (!create_program(config->gamma))
+        return !gl_ext.core_profile;
+
+    gl_ext.GenBuffers(1, &vbo);
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl_ext.BufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+
+    if (gl_ext.vao) {
+        gl_ext.GenVertexArrays(1, &vao);
+        gl_ext.BindVertexArray(vao);
+        bind_quad_attribs();
+        gl_ext.BindVertexArray(0);
+    }
+    gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    use_shader = true;
+    return true;
+}
+
+void presenter_deinit(void)
+{
+    if (!use_shader)
+        return;
+
+    if (vao)
+        gl_ext.DeleteVertexArrays(1, &vao);
+    gl_ext.DeleteBuffers(1, &vbo);
+    gl_ext.DeleteProgram(program);
+    vao = vbo = program = 0;
+    use_shader = false;
+}
+
+bool presenter_uses_shader(void)
+{
+    return use_shader;
+}
+
+void presenter_set_crop(float u, float v)
+{
+    // Applied per quad in presenter_draw
+    crop_u = u;
+    crop_v = v;
+}
+
+void presenter_set_layers(const presenter_layer_t *new_layers, int count)
+{
+    layer_count = count < PRESENTER_MAX_LAYERS ? count : PRESENTER_MAX_LAYERS;
+    for (int i = 0; i < layer_count; i++) {
+        if (layers[i].texture != new_layers[i].texture)
+            set_texture_params(new_layers[i].texture);
+        layers[i] = new_layers[i];
+    }
+}
+
+void presenter_set_overlay(presenter_overlay_cb_t draw)
+{
+    overlay = draw;
+}
+
+void presenter_set_view(int32_t width, int32_t height, presenter_rotation_t new_rotation)
+{
+    frame_width = width > 0 ? width : 1;
+    frame_height = height > 0 ? height : 1;
+    rotation = new_rotation;
+}
+
+static void window_size(int32_t *width, int32_t *height)
+{
+    bool transposed = rotation == PRESENTER_ROTATION_90 || rotation == PRESENTER_ROTATION_270;
+    *width = transposed ? frame_height : frame_width;
+    *height = transposed ? frame_width : frame_height;
+}
+
+void presenter_window_to_frame(double x, double y, int32_t *frame_x, int32_t *frame_y)
+{
+    int32_t w, h;
+    window_size(&w, &h);
+    switch (rotation) {
+    case PRESENTER_ROTATION_90:
+        *frame_x = (int32_t)y;
+        *frame_y = (int32_t)(w - 1 - x);
+        break;
+    case PRESENTER_ROTATION_180:
+        *frame_x = (int32_t)(w - 1 - x);
+        *frame_y = (int32_t)(h - 1 - y);
+        break;
+    case PRESENTER_ROTATION_270:
+        *frame_x = (int32_t)(h - 1 - y);
+        *frame_y = (int32_t)x;
+        break;
+    default:
+        *frame_x = (int32_t)x;
+        *frame_y = (int32_t)y;
+        break;
+    }
+}
+
+// p after q
+static affine_t affine_mul(affine_t p, affine_t q)
+{
+    affine_t r = {
+        p.a * q.a + p.b * q.d, p.a * q.b + p.b * q.e, p.a * q.c + p.b * q.f + p.c,
+        p.d * q.a + p.e * q.d, p.d * q.b + p.e * q.e, p.d * q.c + p.e * q.f + p.f,
+    };
+    return r;
+}
+
+// Frame unit square -> frame pixels -> layer transform -> rotated into window
+// pixels -> clip space
+static affine_t quad_position(const float *transform)
+{
+    float w = (float)frame_width;
+    float h = (float)frame_height;
+    affine_t m = { w, 0.0f, 0.0f, 0.0f, h, 0.0f };
+
+    if (transform) {
+        affine_t t = { transform[0], transform[1], transform[2], transform[3], transform[4], transform[5] };
+        m = affine_mul(t, m);
+    }
+
+    // Clockwise, like lv_display_set_rotation
+    affine_t r = identity;
+    if (rotation == PRESENTER_ROTATION_90)
+        r = (affine_t){ 0.0f, -1.0f, h, 1.0f, 0.0f, 0.0f };
+    else if (rotation == PRESENTER_ROTATION_180)
+        r = (affine_t){ -1.0f, 0.0f, w, 0.0f, -1.0f, h };
+    else if (rotation == PRESENTER_ROTATION_270)
+        r = (affine_t){ 0.0f, 1.0f, 0.0f, -1.0f, 0.0f, w };
+    m = affine_mul(r, m);
+
+    int32_t window_w, window_h;
+    window_size(&window_w, &window_h);
+    affine_t clip = { 2.0f / window_w, 0.0f, -1.0f, 0.0f, -2.0f / window_h, 1.0f };
+    return affine_mul(clip, m);
+}
+
+GLenum presenter_upload_format(void)
+{
+    return use_shader ? GL_RGBA : GL_BGRA;
+}
+
+static void draw_quad(GLuint tex, float u, float v, bool blend, const float *transform)
+{
+    affine_t m = quad_position(transform);
+
+    if (blend) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    if (use_shader) {
+        gl_ext.Uniform2f(crop_location, u, v);
+        gl_ext.Uniform1f(blend_location, blend ? 1.0f : 0.0f);
+        gl_ext.Uniform3f(position_x_location, m.a, m.b, m.c);
+        gl_ext.Uniform3f(position_y_location, m.d, m.e, m.f);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        if (vao) {
+            gl_ext.BindVertexArray(vao);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            gl_ext.BindVertexArray(0);
+        }
+        else {
+            bind_quad_attribs();
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            gl_ext.BindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+    else {
+        // Draw a fullscreen quad with the texture
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0, v); glVertex2f(m.b + m.c, m.e + m.f);
+        glTexCoord2f(u, v); glVertex2f(m.a + m.b + m.c, m.d + m.e + m.f);
+        glTexCoord2f(u, 0); glVertex2f(m.a + m.c, m.d + m.f);
+        glTexCoord2f(0, 0); glVertex2f(m.c, m.f);
+        glEnd();
+    }
+
+    if (blend)
+        glDisable(GL_BLEND);
+}
+
+void presenter_draw(void)
+{
+    // Clear the screen
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (use_shader) {
+        gl_ext.UseProgram(program);
+        gl_ext.ActiveTexture(GL_TEXTURE0);
+    }
+    else {
+        glEnable(GL_TEXTURE_2D);
+    }
+
+    // The layers bottom up, then the LVGL texture, which has alpha once it is on top of any
+    for (int i = 0; i < layer_count; i++)
+        draw_quad(layers[i].texture, layers[i].crop_u, layers[i].crop_v, layers[i].blend,
+                  layers[i].transformed ? layers[i].transform : NULL);
+    draw_quad(texture, crop_u, crop_v, layer_count > 0, NULL);
+
+    if (use_shader)
+        gl_ext.UseProgram(0);
+    else
+        glDisable(GL_TEXTURE_2D);
+
+    if (overlay) {
+        int32_t width, height;
+        window_size(&width, &height);
+        overlay(width, height);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef PRESENTER_H
+#define PRESENTER_H
+
+#include <stdbool.h>
+#include "gl_ext.h"
+
+typedef enum {
+    PRESENTER_FILTER_NEAREST,
+    PRESENTER_FILTER_LINEAR,
+} presenter_filter_t;
+
+typedef struct {
+    presenter_filter_t filter;  // used when the window and the texture differ in size
+    float gamma;                // output gamma applied in the shader, 1.0 = unchanged
+    bool legacy;                // force the fixed-function path
+} presenter_config_t;
+
+// Draws the LVGL texture as a fullscreen quad. With GLSL available this uses a
+// VAO/VBO and a small shader that swizzles LVGL's XRGB8888 (B, G, R, X in
+// memory) to RGB, so the pixels can be uploaded as plain RGBA bytes without any
+// conversion in the driver. Otherwise it falls back to glBegin/glEnd and asks
+// the driver to swizzle by uploading as GL_BGRA.
+//
+// Returns false if no path works, i.e. a core profile context without GLSL.
+bool presenter_init(GLuint texture, const presenter_config_t *config);
+void presenter_deinit(void);
+
+bool presenter_uses_shader(void);
+
+// Pixel format to pass to glTexSubImage2D for LVGL's native pixels.
+GLenum presenter_upload_format(void);
+
+// The texture can be larger than the frame it holds, so resizing the window does
+// not re-specify it every time: only the top-left `u` x `v` fraction is drawn.
+// Defaults to 1, 1.
+void presenter_set_crop(float u, float v);
+
+typedef enum {
+    PRESENTER_ROTATION_0,
+    PRESENTER_ROTATION_90,  // clockwise
+    PRESENTER_ROTATION_180,
+    PRESENTER_ROTATION_270,
+} presenter_rotation_t;
+
+// LVGL renders an unrotated `width` x `height` frame; the presenter turns it (and
+// the layers) by `rotation` onto the window, which is `height` x `width` for the
+// quarter turns. Rotating on the GPU leaves LVGL's SW rotation unused.
+void presenter_set_view(int32_t width, int32_t height, presenter_rotation_t rotation);
+
+// Map a window position, e.g. the cursor, into the frame.
+void presenter_window_to_frame(double x, double y, int32_t *frame_x, int32_t *frame_y);
+
+// Textures drawn under the LVGL texture, bottom first, each covering the frame
+// like it unless given a transform. Once any are set the LVGL texture is blended on top with the
+// alpha in its fourth byte, so it must hold ARGB8888 rather than XRGB8888.
+#define PRESENTER_MAX_LAYERS 4
+
+typedef struct {
+    GLuint texture;     // holding LVGL pixels, uploaded in presenter_upload_format()
+    float crop_u;       // as presenter_set_crop
+    float crop_v;
+    bool blend;         // ARGB8888: blend by alpha, else drawn opaque
+    bool transformed;   // draw the quad through `transform` instead of covering the frame
+    float transform[6]; // affine in frame pixels: x' = t0 x + t1 y + t2, y' = t3 x + t4 y + t5
+} presenter_layer_t;
+
+void presenter_set_layers(const presenter_layer_t *layers, int count);
+
+// Drawn after the texture, over the whole view, in window pixels of the rotated
+// view; NULL for none. Receives no program or texture state and must leave blending,
+// texturing and the current color (fixed-function) as it found them.
+typedef void (*presenter_overlay_cb_t)(int32_t width, int32_t height);
+void presenter_set_overlay(presenter_overlay_cb_t draw);
+
+// Clear the framebuffer and draw the layers, the texture and the overlay over the current viewport.
+void presenter_draw(void);
+
+#endif // PRESENTER_H
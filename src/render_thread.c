@@ -0,0 +1,104 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "lvgl.h"
+#include "render_thread.h"
+
+static pthread_t thread;
+static bool running;
+static void (*thread_run)(void);
+static atomic_bool quit;
+
+static pthread_mutex_t wake_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond;
+static pthread_once_t wake_cond_once = PTHREAD_ONCE_INIT;
+static bool wake_pending;
+
+// Timed waits run on CLOCK_MONOTONIC, so a wall clock change cannot stall or
+// spin the LVGL thread
+static void init_wake_cond(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&wake_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void *thread_main(void *arg)
+{
+    thread_run();
+    return NULL;
+}
+
+bool render_thread_start(void (*run)(void))
+{
+    thread_run = run;
+    atomic_store(&quit, false);
+    pthread_once(&wake_cond_once, init_wake_cond);
+
+    running = pthread_create(&thread, NULL, thread_main, NULL) == 0;
+    return running;
+}
+
+void render_thread_stop(void)
+{
+    if (!running)
+        return;
+
+    atomic_store(&quit, true);
+    render_thread_wake();
+    pthread_join(thread, NULL);
+    running = false;
+}
+
+bool render_thread_should_quit(void)
+{
+    return atomic_load(&quit);
+}
+
+void render_thread_wake(void)
+{
+    pthread_once(&wake_cond_once, init_wake_cond);
+    pthread_mutex_lock(&wake_mutex);
+    wake_pending = true;
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_mutex);
+}
+
+void render_thread_wait(uint32_t ms)
+{
+#ifdef __APPLE__
+    // No pthread_condattr_setclock; the relative wait is unaffected by the wall clock
+    struct timespec timeout = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (ms != LV_NO_TIMER_READY) {
+        deadline.tv_sec += ms / 1000;
+        deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+#endif
+
+    pthread_mutex_lock(&wake_mutex);
+    while (!wake_pending && !atomic_load(&quit)) {
+        if (ms == LV_NO_TIMER_READY)
+            pthread_cond_wait(&wake_cond, &wake_mutex);
+#ifdef __APPLE__
+        else if (pthread_cond_timedwait_relative_np(&wake_cond, &wake_mutex, &timeout) == ETIMEDOUT)
+            break;
+#else
+        else if (pthread_cond_timedwait(&wake_cond, &wake_mutex, &deadline) == ETIMEDOUT)
+            break;
+#endif
+    }
+    wake_pending = false;
+    pthread_mutex_unlock(&wake_mutex);
+}
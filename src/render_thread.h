@@ -0,0 +1,22 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The thread LVGL runs on in the threaded loop mode, plus the wakeup the main
+// thread uses to cut its sleep short when new input was queued.
+
+bool render_thread_start(void (*run)(void));
+
+// Ask the thread to finish, wake it and wait for it.
+void render_thread_stop(void);
+bool render_thread_should_quit(void);
+
+// Main thread: end the current render_thread_wait early.
+void render_thread_wake(void);
+
+// Render thread: sleep up to `ms` (forever for LV_NO_TIMER_READY) or until woken.
+void render_thread_wait(uint32_t ms);
+
+#endif // RENDER_THREAD_H
@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include "lvgl_private.h"  // lv_draw_task_t and lv_layer_t internals
+#include "tiled_draw.h"
+
+static void band_area(lv_area_t *band, const lv_area_t *area, int i, int bands)
+{
+    int32_t height = lv_area_get_height(area);
+    *band = *area;
+    band->y1 = area->y1 + height * i / bands;
+    band->y2 = area->y1 + height * (i + 1) / bands - 1;
+}
+
+static void draw_task_added_cb(lv_event_t *e)
+{
+    lv_draw_task_t *t = lv_event_get_draw_task(e);
+    int bands = (int)(intptr_t)lv_event_get_user_data(e);
+    if (t->type != LV_DRAW_TASK_TYPE_FILL)
+        return;
+
+    lv_area_t area;
+    if (!lv_area_intersect(&area, &t->area, &t->clip_area) || lv_area_get_size(&area) < TILED_DRAW_MIN_PX)
+        return;
+    if (bands > lv_area_get_height(&area))
+        bands = lv_area_get_height(&area);
+
+    // Tasks added from this event are not sent to it again. Each one gets the
+    // full coordinates, so the gradient is laid out as before, but is clipped to
+    // its band. Its real area is narrowed to match so LVGL sees the bands as
+    // independent and dispatches them to different units.
+    lv_draw_fill_dsc_t *dsc = t->draw_dsc;
+    lv_layer_t *layer = dsc->base.layer;
+    lv_area_t saved_clip = layer->_clip_area;
+    lv_draw_task_t *last = t;
+    for (int i = 1; i < bands; i++) {
+        lv_area_t band;
+        band_area(&band, &area, i, bands);
+        layer->_clip_area = band;
+        lv_draw_fill(layer, dsc, &t->area);
+
+        while (last->next)
+            last = last->next;
+        lv_area_intersect(&last->_real_area, &last->_real_area, &band);
+    }
+    layer->_clip_area = saved_clip;
+
+    // The original task keeps the first band
+    lv_area_t first;
+    band_area(&first, &area, 0, bands);
+    t->clip_area = first;
+    lv_area_intersect(&t->_real_area, &t->_real_area, &first);
+}
+
+void tiled_draw_enable(lv_obj_t *obj, int bands)
+{
+    if (bands < 2)
+        return;
+
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+    lv_obj_add_event_cb(obj, draw_task_added_cb, LV_EVENT_DRAW_TASK_ADDED, (void *)(intptr_t)bands);
+}
@@ -0,0 +1,17 @@
+#ifndef TILED_DRAW_H
+#define TILED_DRAW_H
+
+#include "lvgl.h"
+
+// Fills smaller than this are left as a single draw task
+#define TILED_DRAW_MIN_PX (64 * 1024)
+
+// LVGL hands every draw task to exactly one draw unit, so a full-screen fill such
+// as the radial gradient background keeps one thread busy while the others wait.
+// This splits the large fills drawn by obj into `bands` horizontal bands, each
+// its own task clipped to its band, which the SW draw units render in parallel.
+// The gradient is still evaluated over the whole object, so the result is
+// identical to the unsplit fill.
+void tiled_draw_enable(lv_obj_t *obj, int bands);
+
+#endif // TILED_DRAW_H
@@ -0,0 +1,197 @@
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trace_profiler.h"
+
+typedef struct {
+    uint64_t time;          // [ns] trace clock
+    uint64_t duration;      // [ns] complete events only
+    const char *name;
+    uint32_t thread;
+    char phase;             // 'B'egin, 'E'nd, 'X' complete
+} trace_event_t;
+
+atomic_bool trace_profiler_active;
+
+static trace_event_t *ring;
+static atomic_ullong written;   // events ever written; the ring holds the last TRACE_PROFILER_CAPACITY
+static uint64_t start_time;
+static const char *path;
+static volatile sig_atomic_t dump_requested;
+
+// Threads are numbered as they first write; tracks take numbers from the same range
+static atomic_uint thread_count;
+static _Thread_local uint32_t thread_id;
+static const char *thread_names[TRACE_PROFILER_MAX_THREADS + 1];
+
+static void dump_signal_handler(int sig)
+{
+    dump_requested = 1;
+}
+
+uint64_t trace_profiler_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t current_thread(void)
+{
+    if (!thread_id)
+        thread_id = atomic_fetch_add_explicit(&thread_count, 1, memory_order_relaxed) + 1;
+    return thread_id;
+}
+
+static void put(uint32_t thread, const char *name, char phase, uint64_t time, uint64_t duration)
+{
+    // Writers never wait for each other: each claims the next slot, overwriting the oldest
+    uint64_t index = atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+    trace_event_t *event = &ring[index % TRACE_PROFILER_CAPACITY];
+    event->time = time;
+    event->duration = duration;
+    event->name = name;
+    event->thread = thread;
+    event->phase = phase;
+}
+
+void trace_profiler_write(const char *name, char phase)
+{
+    put(current_thread(), name, phase, trace_profiler_now_ns(), 0);
+}
+
+void trace_profiler_complete(uint32_t track, const char *name, uint64_t start_ns, uint64_t duration_ns)
+{
+    if (TRACE_PROFILER_IS_ACTIVE() && track)
+        put(track, name, 'X', start_ns, duration_ns);
+}
+
+bool trace_profiler_start(const char *file)
+{
+    ring = calloc(TRACE_PROFILER_CAPACITY, sizeof(trace_event_t));
+    if (!ring)
+        return false;
+
+    path = file;
+    atomic_store(&written, 0);
+    start_time = trace_profiler_now_ns();
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dump_signal_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, NULL);
+
+    atomic_store_explicit(&trace_profiler_active, true, memory_order_relaxed);
+    return true;
+}
+
+void trace_profiler_stop(void)
+{
+    if (!ring)
+        return;
+
+    atomic_store_explicit(&trace_profiler_active, false, memory_order_relaxed);
+    signal(SIGUSR1, SIG_DFL);
+    free(ring);
+    ring = NULL;
+}
+
+void trace_profiler_set_thread_name(const char *name)
+{
+    uint32_t thread = current_thread();
+    if (thread <= TRACE_PROFILER_MAX_THREADS)
+        thread_names[thread] = name;
+}
+
+uint32_t trace_profiler_add_track(const char *name)
+{
+    uint32_t track = atomic_fetch_add_explicit(&thread_count, 1, memory_order_relaxed) + 1;
+    if (track > TRACE_PROFILER_MAX_THREADS)
+        return 0;
+    thread_names[track] = name;
+    return track;
+}
+
+void trace_profiler_poll(void)
+{
+    if (!dump_requested)
+        return;
+
+    dump_requested = 0;
+    int events = trace_profiler_dump();
+    if (events < 0)
+        fprintf(stderr, "Could not write %s\n", path);
+    else
+        printf("[trace] %d events written to %s\n", events, path);
+}
+
+static void put_string(FILE *file, const char *s)
+{
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(file, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(file, "\\u%04x", *s);
+        else
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+int trace_profiler_dump(void)
+{
+    if (!ring)
+        return 0;
+
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return -1;
+
+    // Stop recording meanwhile; a writer already past the flag may still land in the ring
+    atomic_store_explicit(&trace_profiler_active, false, memory_order_relaxed);
+    uint64_t end = atomic_load(&written);
+    uint64_t begin = end > TRACE_PROFILER_CAPACITY ? end - TRACE_PROFILER_CAPACITY : 0;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"lvgl_glfw\"}}");
+    uint32_t threads = atomic_load(&thread_count);
+    if (threads > TRACE_PROFILER_MAX_THREADS)
+        threads = TRACE_PROFILER_MAX_THREADS;
+    for (uint32_t i = 1; i <= threads; i++) {
+        if (!thread_names[i])
+            continue;
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", i);
+        put_string(file, thread_names[i]);
+        fprintf(file, "}}");
+    }
+
+    int count = 0;
+    for (uint64_t i = begin; i < end; i++) {
+        const trace_event_t *event = &ring[i % TRACE_PROFILER_CAPACITY];
+        if (!event->name || event->time < start_time)
+            continue;
+        fprintf(file, ",\n{\"name\":");
+        put_string(file, event->name);
+        fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", event->phase, event->thread,
+                (event->time - start_time) / 1000.0);
+        if (event->phase == 'X')
+            fprintf(file, ",\"dur\":%.3f", event->duration / 1000.0);
+        fputc('}', file);
+        count++;
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    atomic_store_explicit(&trace_profiler_active, true, memory_order_relaxed);
+    return fclose(file) == 0 ? count : -1;
+}
+
+const char *trace_profiler_get_path(void)
+{
+    return path;
+}
@@ -0,0 +1,58 @@
+#ifndef TRACE_PROFILER_H
+#define TRACE_PROFILER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// LVGL's profiler backend (LV_PROFILER_INCLUDE in lv_conf.h, built with
+// LVGL_GLFW_TRACE): LVGL's begin and end points, plus the app's own, are kept
+// in a ring of trace events and written out as Chrome trace-event JSON, for
+// chrome://tracing or ui.perfetto.dev. While not started each point is a
+// relaxed load of one flag, which the render and SW draw threads read while the
+// main thread sets it.
+//
+// Compiled into the lvgl library, so it must not depend on GLFW or GL; GPU
+// spans come in through trace_profiler_complete (gl_trace.h).
+
+#define TRACE_PROFILER_CAPACITY (256 * 1024)    // events kept; older ones are overwritten
+#define TRACE_PROFILER_MAX_THREADS 64           // named threads and tracks
+
+extern atomic_bool trace_profiler_active;
+
+void trace_profiler_write(const char *name, char phase);
+
+// `tag` must stay valid until the trace is dumped: a literal or __func__
+#define TRACE_PROFILER_IS_ACTIVE()    atomic_load_explicit(&trace_profiler_active, memory_order_relaxed)
+#define TRACE_PROFILER_BEGIN_TAG(tag) do { if (TRACE_PROFILER_IS_ACTIVE()) trace_profiler_write((tag), 'B'); } while (0)
+#define TRACE_PROFILER_END_TAG(tag)   do { if (TRACE_PROFILER_IS_ACTIVE()) trace_profiler_write((tag), 'E'); } while (0)
+#define TRACE_PROFILER_BEGIN          TRACE_PROFILER_BEGIN_TAG(__func__)
+#define TRACE_PROFILER_END            TRACE_PROFILER_END_TAG(__func__)
+
+// Start recording, to be dumped to `path` at exit and whenever SIGUSR1 arrives.
+// Returns false if the ring cannot be allocated.
+bool trace_profiler_start(const char *path);
+void trace_profiler_stop(void);
+
+// Name the calling thread in the trace.
+void trace_profiler_set_thread_name(const char *name);
+
+// A track of its own, e.g. for GPU work; returns 0 if there are too many.
+uint32_t trace_profiler_add_track(const char *name);
+
+// The trace clock (CLOCK_MONOTONIC).
+uint64_t trace_profiler_now_ns(void);
+
+// A span measured elsewhere, on `track`.
+void trace_profiler_complete(uint32_t track, const char *name, uint64_t start_ns, uint64_t duration_ns);
+
+// Main thread, once per loop iteration: write the dump SIGUSR1 asked for. The
+// loop must not sleep long between calls; the app caps its waits for events.
+void trace_profiler_poll(void);
+
+// Write the events in the ring; returns how many, -1 if the file could not be
+// written.
+int trace_profiler_dump(void);
+const char *trace_profiler_get_path(void);
+
+#endif // TRACE_PROFILER_H